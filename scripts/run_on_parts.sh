@@ -1,5 +1,6 @@
 # run grammar compression on 1/N, 2/N, ... N/N of the file
 # params: command for grammar compression, file
+# (cfg_esa --scaling N -f file runs the same experiment in one process, without prefix files)
 
 cmd=$1
 fname=$2
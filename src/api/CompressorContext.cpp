@@ -0,0 +1,59 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include "CompressorContext.h"
+#include "compress/LongestFirstSaCompressor.h"
+#include "compress/RuleInliner.h"
+#include "compress/GrammarBalancer.h"
+#include "parallel/ChunkCompressor.h"
+#include "util/Profiler.h"
+
+CompressorContext::CompressorContext() { }
+
+CompressorContext::~CompressorContext() { }
+
+// compress string and postprocess the grammar as set in the options
+CompressionResult CompressorContext::compress(const char* s, int len, 
+                                              const CompressionOptions& options) {
+    CompressionResult result;
+    double start = getWallTime();
+    if (options.chunkSize > 0) {
+        ChunkCompressor comp(s, len, options.chunkSize, options.numThreads);
+        result.grammar = comp.compress();
+        // chunks are compressed by other threads, wall time is measured
+        result.metrics.compressionTime = getWallTime() - start;
+    }
+    else {
+        LongestFirstSaCompressor comp(s, len, false, false, &workspace);
+        result.grammar = comp.compress();
+        result.metrics.compressionTime = comp.getCompressionTime();
+    }
+    if (options.inlineThreshold > 0) {
+        RuleInliner inliner(options.inlineThreshold);
+        CfGrammar* inlined = inliner.inlineRules(result.grammar);
+        delete result.grammar;
+        result.grammar = inlined;
+    }
+    if (options.balance) {
+        GrammarBalancer balancer;
+        CfGrammar* balanced = balancer.balance(result.grammar);
+        delete result.grammar;
+        result.grammar = balanced;
+    }
+    if (options.renumber) result.grammar->renumberByFirstUse();
+    result.metrics.totalTime = getWallTime() - start;
+    result.metrics.inputSize = len;
+    result.metrics.grammarSize = result.grammar->getSize();
+    result.metrics.numRules = result.grammar->getNumRules();
+    return result;
+}
@@ -0,0 +1,62 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef COMPRESSORCONTEXT_H
+#define	COMPRESSORCONTEXT_H
+
+#include "compress/CfGrammar.h"
+#include "compress/CompressorWorkspace.h"
+
+// options of compression and postprocessing of the grammar
+struct CompressionOptions {
+    CompressionOptions(): inlineThreshold(0), balance(false), renumber(false), 
+        chunkSize(0), numThreads(1) { }
+    
+    int inlineThreshold; // inline rules saving less symbols, 0 for no inlining
+    bool balance; // balance grammar for random access
+    bool renumber; // renumber rules by first use
+    int chunkSize; // if > 0 compress chunks of this size in parallel
+    int numThreads; // threads for chunk compression
+};
+
+struct CompressionMetrics {
+    double compressionTime; // cpu time of the compression, wall time for chunks
+    double totalTime; // wall time including postprocessing
+    int inputSize;
+    int grammarSize; // number of terminals and non-terminals
+    int numRules;
+};
+
+struct CompressionResult {
+    CfGrammar* grammar; // owned by the caller
+    CompressionMetrics metrics;
+};
+
+/* Context for compressing strings one after the other with reused buffers. 
+ * A context holds no state shared with other contexts, so each thread 
+ * can compress with its own context in parallel with the others. 
+ * One context must not be used by two threads at the same time. */
+class CompressorContext {
+public:
+    CompressorContext();
+    virtual ~CompressorContext();
+    
+    CompressionResult compress(const char* s, int len, 
+                               const CompressionOptions& options = CompressionOptions());
+    
+private:
+    CompressorWorkspace workspace;
+    
+};
+
+#endif	/* COMPRESSORCONTEXT_H */
@@ -0,0 +1,102 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sstream>
+
+#include "cfg_esa.h"
+#include "CompressorContext.h"
+
+struct cfg_esa_context {
+    CompressorContext context;
+};
+
+// copy string to a buffer allocated with malloc, return false if allocation fails
+static bool copyOut(const string& s, char** buffer, size_t* size) {
+    *buffer = (char*)malloc(s.size() > 0 ? s.size() : 1);
+    if (*buffer == 0) return false;
+    memcpy(*buffer, s.data(), s.size());
+    *size = s.size();
+    return true;
+}
+
+void cfg_esa_default_options(cfg_esa_options* options) {
+    CompressionOptions defaults;
+    options->inline_threshold = defaults.inlineThreshold;
+    options->balance = defaults.balance;
+    options->renumber = defaults.renumber;
+    options->chunk_size = defaults.chunkSize;
+    options->num_threads = defaults.numThreads;
+}
+
+cfg_esa_context* cfg_esa_context_create(void) {
+    return new (nothrow) cfg_esa_context;
+}
+
+void cfg_esa_context_destroy(cfg_esa_context* context) {
+    delete context;
+}
+
+int cfg_esa_compress(cfg_esa_context* context, const char* data, size_t size, 
+                     const cfg_esa_options* options, char** grammar, size_t* grammar_size, 
+                     cfg_esa_metrics* metrics) {
+    if (context == 0 || (data == 0 && size > 0) || grammar == 0 || grammar_size == 0) {
+        return CFG_ESA_ERROR_INPUT;
+    }
+    if (size > INT_MAX / 2) return CFG_ESA_ERROR_INPUT;
+    CompressionOptions opt;
+    if (options != 0) {
+        opt.inlineThreshold = options->inline_threshold;
+        opt.balance = options->balance != 0;
+        opt.renumber = options->renumber != 0;
+        opt.chunkSize = options->chunk_size;
+        opt.numThreads = options->num_threads;
+    }
+    try {
+        CompressionResult result = context->context.compress(data, size, opt);
+        ostringstream out;
+        result.grammar->writeBinary(out);
+        delete result.grammar;
+        if (!copyOut(out.str(), grammar, grammar_size)) return CFG_ESA_ERROR_MEMORY;
+        if (metrics != 0) {
+            metrics->compression_time = result.metrics.compressionTime;
+            metrics->total_time = result.metrics.totalTime;
+            metrics->input_size = result.metrics.inputSize;
+            metrics->grammar_size = result.metrics.grammarSize;
+            metrics->num_rules = result.metrics.numRules;
+        }
+    }
+    catch (bad_alloc&) { return CFG_ESA_ERROR_MEMORY; }
+    return CFG_ESA_OK;
+}
+
+int cfg_esa_decompress(const char* grammar, size_t grammar_size, char** data, size_t* size) {
+    if ((grammar == 0 && grammar_size > 0) || data == 0 || size == 0) return CFG_ESA_ERROR_INPUT;
+    try {
+        istringstream in(grammar_size > 0 ? string(grammar, grammar_size) : string());
+        CfGrammar* cfg = CfGrammar::readBinary(in);
+        if (cfg == 0) return CFG_ESA_ERROR_FORMAT;
+        string expanded = cfg->expand();
+        delete cfg;
+        if (!copyOut(expanded, data, size)) return CFG_ESA_ERROR_MEMORY;
+    }
+    catch (bad_alloc&) { return CFG_ESA_ERROR_MEMORY; }
+    return CFG_ESA_OK;
+}
+
+void cfg_esa_free(void* buffer) {
+    free(buffer);
+}
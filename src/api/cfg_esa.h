@@ -0,0 +1,68 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef CFG_ESA_H
+#define	CFG_ESA_H
+
+/* C interface of the compressor. Functions are reentrant, each thread 
+ * compresses with its own context. Buffers returned by the functions 
+ * are allocated by the library and released with cfg_esa_free(). */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CFG_ESA_OK 0
+#define CFG_ESA_ERROR_INPUT -1 /* invalid argument or input too large */
+#define CFG_ESA_ERROR_FORMAT -2 /* malformed grammar */
+#define CFG_ESA_ERROR_MEMORY -3
+
+typedef struct cfg_esa_context cfg_esa_context;
+
+typedef struct cfg_esa_options {
+    int inline_threshold; /* inline rules saving less symbols, 0 for no inlining */
+    int balance; /* balance grammar for random access */
+    int renumber; /* renumber rules by first use */
+    int chunk_size; /* if > 0 compress chunks of this size in parallel */
+    int num_threads; /* threads for chunk compression */
+} cfg_esa_options;
+
+typedef struct cfg_esa_metrics {
+    double compression_time;
+    double total_time;
+    int input_size;
+    int grammar_size;
+    int num_rules;
+} cfg_esa_metrics;
+
+void cfg_esa_default_options(cfg_esa_options* options);
+
+cfg_esa_context* cfg_esa_context_create(void);
+void cfg_esa_context_destroy(cfg_esa_context* context);
+
+/* compress data to grammar in binary format, options and metrics can be null */
+int cfg_esa_compress(cfg_esa_context* context, const char* data, size_t size, 
+                     const cfg_esa_options* options, char** grammar, size_t* grammar_size, 
+                     cfg_esa_metrics* metrics);
+/* expand grammar in binary format */
+int cfg_esa_decompress(const char* grammar, size_t grammar_size, char** data, size_t* size);
+
+void cfg_esa_free(void* buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* CFG_ESA_H */
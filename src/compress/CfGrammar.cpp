@@ -13,15 +13,24 @@
 // under an open source licence. 
 #include <vector>
 #include <sstream>
+#include <cstring>
+#include <climits>
+#include <algorithm>
 
 #include "CfGrammar.h"
+#include "GrammarFingerprint.h"
 
-CfGrammar::CfGrammar(int n): rules(n), numRules(n) {}
+CfGrammar::CfGrammar(int n): rules(n), numRules(n), 
+    hasRefFingerprint(false), refLength(0), refHash(0) {}
     
 void CfGrammar::addRule(int i, CfgRule rule) {
     rules[i] = rule;
 }
 
+int CfGrammar::getNumRules() const { return numRules; }
+
+const CfgRule& CfGrammar::getRule(int i) const { return rules[i]; }
+
 // create string representation of the grammar
 string CfGrammar::toString() {
     string s = "";    
@@ -32,16 +41,24 @@ string CfGrammar::toString() {
     return s;
 }
 
-// expand rule r to string
+// expand rule r to string, iteratively so that deeply nested 
+// grammars do not overflow the call stack
 string CfGrammar::expand(int r) {
-    ostringstream ss;
-    CfgRule rule = rules[r]; int N = rule.numFragments();
-    for (int i = 0; i < N; ++i) {
-        RuleFragment frag = rule.getFragment(i);
-        if (frag.isRule) ss << expand(frag.ruleIndex);
-        else ss << frag.str;
+    string s;
+    // stack of (rule, index of the next fragment to expand) pairs
+    vector<pair<int, int> > stack(1, make_pair(r, 0));
+    while (stack.empty() == false) {
+        pair<int, int>& top = stack.back();
+        const CfgRule& rule = rules[top.first];
+        if (top.second == rule.numFragments()) {
+            stack.pop_back();
+            continue;
+        }
+        const RuleFragment& frag = rule.getFragment(top.second++);
+        if (frag.isRule) stack.push_back(make_pair(frag.ruleIndex, 0));
+        else s += frag.str;
     }
-    return ss.str();
+    return s;
 }
 
 // get string "title" of the rule with index i
@@ -71,20 +88,296 @@ string CfGrammar::fragmentString(RuleFragment f) {
 void CfGrammar::calcSize() {
     numNonterms = 0;
     numTerms = 0;
+    numRefs = 0;
     for(int i = 0; i < numRules; ++i) {
         CfgRule rule = rules[i];
         for (int j = 0; j < rule.numFragments(); ++j) {
             RuleFragment frag = rule.getFragment(j);
             if (frag.isRule) numNonterms++;
+            else if (frag.refPos >= 0) numRefs++;
             else numTerms += frag.str.size();
         }
     }
 }
 
+// size of the grammar, number of terminals and non-terminals in all the rules,
+// a reference to the reference text counts as two symbols, position and length
+int CfGrammar::getSize() {
+    calcSize();
+    return numTerms + numNonterms + 2 * numRefs;
+}
+
+// bytes of memory used by the grammar, approximately
+long CfGrammar::getMemoryBytes() const {
+    long bytes = sizeof(CfGrammar) + rules.capacity() * sizeof(CfgRule);
+    for (int i = 0; i < rules.size(); ++i) bytes += rules[i].getMemoryBytes();
+    return bytes;
+}
+
 void CfGrammar::printSize(ostream& out) {
     calcSize();
     out << "num_rules: " << numRules << " num_non_terminals: " << numNonterms 
          << " num_terminals: " << numTerms;
+    if (numRefs > 0) out << " num_references: " << numRefs;
+}
+
+// return indexes of all the rules ordered so that every rule 
+// comes after all the rules occurring in its fragments
+vector<int> CfGrammar::bottomUpOrder() const {
+    vector<int> order; order.reserve(numRules);
+    vector<char> visited(numRules, 0);
+    // stack of (rule, index of the next fragment to visit) pairs, 
+    // iterative to avoid deep recursion on deeply nested grammars
+    vector<pair<int, int> > stack;
+    for (int r = 0; r < numRules; ++r) {
+        if (visited[r]) continue;
+        visited[r] = 1;
+        stack.push_back(make_pair(r, 0));
+        while (stack.empty() == false) {
+            pair<int, int>& top = stack.back();
+            const CfgRule& rule = rules[top.first];
+            if (top.second == rule.numFragments()) {
+                order.push_back(top.first);
+                stack.pop_back();
+                continue;
+            }
+            const RuleFragment& frag = rule.getFragment(top.second++);
+            if (frag.isRule && !visited[frag.ruleIndex]) {
+                visited[frag.ruleIndex] = 1;
+                stack.push_back(make_pair(frag.ruleIndex, 0));
+            }
+        }
+    }
+    return order;
+}
+
+// renumber the rules by order of first use in depth first expansion of R0, 
+// so that rules expanded one after the other are close in the rule table 
+// and in the text and binary output. unused rules are put at the end
+void CfGrammar::renumberByFirstUse() {
+    vector<int> newIndex(numRules, -1);
+    int next = 0;
+    newIndex[0] = next++;
+    vector<pair<int, int> > stack; // (rule, next fragment) pairs
+    stack.push_back(make_pair(0, 0));
+    while (stack.empty() == false) {
+        pair<int, int>& top = stack.back();
+        const CfgRule& rule = rules[top.first];
+        if (top.second == rule.numFragments()) { stack.pop_back(); continue; }
+        const RuleFragment& frag = rule.getFragment(top.second++);
+        if (frag.isRule && newIndex[frag.ruleIndex] == -1) {
+            newIndex[frag.ruleIndex] = next++;
+            stack.push_back(make_pair(frag.ruleIndex, 0));
+        }
+    }
+    for (int r = 0; r < numRules; ++r) if (newIndex[r] == -1) newIndex[r] = next++;
+    // move the rules and rewrite rule indexes in fragments
+    vector<CfgRule> renumbered(numRules);
+    for (int r = 0; r < numRules; ++r) {
+        CfgRule& rule = renumbered[newIndex[r]];
+        for (int f = 0; f < rules[r].numFragments(); ++f) {
+            RuleFragment frag = rules[r].getFragment(f);
+            if (frag.isRule) frag.ruleIndex = newIndex[frag.ruleIndex];
+            rule.addFragment(frag);
+        }
+    }
+    rules.swap(renumbered);
+}
+
+// true if the rules reference only existing rules, there is no cycle 
+// of rule references and the expansion of each rule is shorter than INT_MAX
+bool CfGrammar::isValid() const {
+    vector<char> state(numRules, 0); // 0 not visited, 1 on the stack, 2 done
+    vector<long> length(numRules, 0);
+    vector<pair<int, int> > stack;
+    for (int r = 0; r < numRules; ++r) {
+        if (state[r] != 0) continue;
+        state[r] = 1;
+        stack.push_back(make_pair(r, 0));
+        while (stack.empty() == false) {
+            pair<int, int>& top = stack.back();
+            const CfgRule& rule = rules[top.first];
+            if (top.second == rule.numFragments()) { // subrules are done
+                long len = 0;
+                for (int f = 0; f < rule.numFragments(); ++f) {
+                    const RuleFragment& frag = rule.getFragment(f);
+                    if (frag.isRule) len += length[frag.ruleIndex];
+                    else len += frag.str.empty() ? frag.refLen : frag.str.size();
+                    if (len > INT_MAX) return false;
+                }
+                length[top.first] = len;
+                state[top.first] = 2;
+                stack.pop_back();
+                continue;
+            }
+            const RuleFragment& frag = rule.getFragment(top.second++);
+            if (!frag.isRule) continue;
+            if (frag.ruleIndex < 0 || frag.ruleIndex >= numRules) return false;
+            if (state[frag.ruleIndex] == 1) return false; // cycle
+            if (state[frag.ruleIndex] == 0) {
+                state[frag.ruleIndex] = 1;
+                stack.push_back(make_pair(frag.ruleIndex, 0));
+            }
+        }
+    }
+    return true;
+}
+
+// binary format: magic, number of rules, then for each rule number of 
+// fragments followed by fragments, a fragment is a type byte and either 
+// rule index, string length and characters, or reference position and length, 
+// grammars referencing a text have a second magic followed by the length 
+// and fingerprint hash of the text before the number of rules
+static const char BINARY_MAGIC[4] = {'C', 'F', 'G', 'B'};
+static const char BINARY_REF_MAGIC[4] = {'C', 'F', 'G', 'R'};
+
+static void writeInt(ostream& out, int i) { out.write((const char *)&i, sizeof(int)); }
+
+static bool readInt(istream& in, int& i) { 
+    in.read((char *)&i, sizeof(int)); 
+    return in.good();
+}
+
+// read len chars into s in blocks, so that a corrupt length can not 
+// allocate more memory than the input holds
+static bool readChars(istream& in, string& s, int len) {
+    const int blockSize = 1 << 16;
+    s.clear();
+    while (len > 0) {
+        const int n = min(len, blockSize), old = s.size();
+        s.resize(old + n);
+        in.read(&s[old], n);
+        if (in.gcount() != n) return false;
+        len -= n;
+    }
+    return true;
+}
+
+// write grammar in binary format
+void CfGrammar::writeBinary(ostream& out) {
+    if (hasRefFingerprint) {
+        out.write(BINARY_REF_MAGIC, sizeof(BINARY_REF_MAGIC));
+        writeInt(out, refLength);
+        out.write((const char *)&refHash, sizeof(refHash));
+    }
+    else out.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    writeInt(out, numRules);
+    for (int i = 0; i < numRules; ++i) writeRuleBinary(out, rules[i]);
+}
+
+// write number of fragments of the rule followed by the fragments
+void CfGrammar::writeRuleBinary(ostream& out, const CfgRule& rule) {
+    writeInt(out, rule.numFragments());
+    for (int j = 0; j < rule.numFragments(); ++j) {
+        const RuleFragment& frag = rule.getFragment(j);
+        out.put(frag.isRule ? 1 : (frag.refPos >= 0 ? 2 : 0));
+        if (frag.isRule) writeInt(out, frag.ruleIndex);
+        else if (frag.refPos >= 0) {
+            writeInt(out, frag.refPos);
+            writeInt(out, frag.str.empty() ? frag.refLen : frag.str.size());
+        }
+        else {
+            writeInt(out, frag.str.size());
+            out.write(frag.str.data(), frag.str.size());
+        }
+    }
+}
+
+// read grammar written by writeBinary(), return 0 if the input is malformed, 
+// memory is allocated as the rules are read so a corrupt number of rules 
+// or string length fails at the end of the input instead of allocating it
+CfGrammar* CfGrammar::readBinary(istream& in) {
+    char magic[sizeof(BINARY_MAGIC)];
+    in.read(magic, sizeof(magic));
+    if (!in.good()) return 0;
+    const bool hasRef = memcmp(magic, BINARY_REF_MAGIC, sizeof(magic)) == 0;
+    if (!hasRef && memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0) return 0;
+    int refLen = 0;
+    unsigned long long refHash = 0;
+    if (hasRef) {
+        if (!readInt(in, refLen) || refLen < 0) return 0;
+        in.read((char *)&refHash, sizeof(refHash));
+        if (!in.good()) return 0;
+    }
+    int n;
+    if (!readInt(in, n) || n < 1) return 0;
+    vector<CfgRule> read;
+    read.reserve(min(n, 1 << 16));
+    for (int i = 0; i < n; ++i) {
+        read.push_back(CfgRule());
+        if (!readRuleBinary(in, read.back(), n)) return 0;
+    }
+    CfGrammar* grammar = new CfGrammar(0);
+    grammar->rules.swap(read);
+    grammar->numRules = n;
+    grammar->hasRefFingerprint = hasRef;
+    grammar->refLength = refLen;
+    grammar->refHash = refHash;
+    if (!grammar->isValid()) { delete grammar; return 0; }
+    return grammar;
+}
+
+// read rule written by writeRuleBinary(), rule indexes must be smaller 
+// than numRules unless numRules is negative, return false on malformed input
+bool CfGrammar::readRuleBinary(istream& in, CfgRule& rule, int numRules) {
+    int nf;
+    if (!readInt(in, nf) || nf < 0) return false;
+    for (int j = 0; j < nf; ++j) {
+        RuleFragment frag;
+        int type = in.get(), val;
+        if (type != 0 && type != 1 && type != 2) return false;
+        if (!readInt(in, val) || val < 0) return false;
+        frag.isRule = (type == 1);
+        if (frag.isRule) {
+            if (numRules >= 0 && val >= numRules) return false;
+            frag.ruleIndex = val;
+        }
+        else if (type == 2) { // chars are set by setReferenceText()
+            int len;
+            if (!readInt(in, len) || len < 0) return false;
+            frag.refPos = val;
+            frag.refLen = len;
+        }
+        else if (!readChars(in, frag.str, val)) return false;
+        rule.addFragment(frag);
+    }
+    return true;
+}
+
+// set strings of the fragments referencing the reference text, return false 
+// if a reference is out of the text or the text differs from the one the 
+// grammar was compressed against
+bool CfGrammar::setReferenceText(const string& ref) {
+    if (hasRefFingerprint) {
+        if ((long)ref.size() != refLength) return false;
+        if (GrammarFingerprint::ofString(ref.data(), ref.size()).hash != refHash) return false;
+    }
+    for (int i = 0; i < numRules; ++i) {
+        for (int j = 0; j < rules[i].numFragments(); ++j) {
+            RuleFragment frag = rules[i].getFragment(j);
+            if (frag.isRule || frag.refPos < 0) continue;
+            const long len = frag.str.empty() ? frag.refLen : frag.str.size();
+            if (frag.refPos + len > (long)ref.size()) return false;
+            frag.str = ref.substr(frag.refPos, len);
+            rules[i].setFragment(j, frag);
+        }
+    }
+    return true;
+}
+
+// remember the length and fingerprint of the reference text, so that 
+// setReferenceText() of the grammar read back rejects another text
+void CfGrammar::setReferenceFingerprint(const string& ref) {
+    hasRefFingerprint = true;
+    refLength = ref.size();
+    refHash = GrammarFingerprint::ofString(ref.data(), ref.size()).hash;
+}
+
+// take over the reference fingerprint of a grammar this one was derived from
+void CfGrammar::copyReferenceFingerprint(const CfGrammar& g) {
+    hasRefFingerprint = g.hasRefFingerprint;
+    refLength = g.refLength;
+    refHash = g.refHash;
 }
 
 CfGrammar::~CfGrammar() {
@@ -114,7 +407,18 @@ void CfgRule::addFragment(RuleFragment f) {
     fragments.push_back(f);
 }
 
-int CfgRule::numFragments() { return fragments.size(); }
+void CfgRule::setFragment(int i, RuleFragment f) { fragments.at(i) = f; }
+
+int CfgRule::numFragments() const { return fragments.size(); }
+
+// bytes allocated for the fragments, short strings are kept within the string object
+long CfgRule::getMemoryBytes() const {
+    long bytes = fragments.capacity() * sizeof(RuleFragment);
+    for (int i = 0; i < fragments.size(); ++i) {
+        if (fragments[i].str.capacity() > 15) bytes += fragments[i].str.capacity() + 1;
+    }
+    return bytes;
+}
 
-RuleFragment CfgRule::getFragment(int i) { return fragments.at(i); }
+const RuleFragment& CfgRule::getFragment(int i) const { return fragments.at(i); }
 
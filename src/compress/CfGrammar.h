@@ -22,10 +22,16 @@
 using namespace std;
 
 // part of a rule, either a string or a rule (index)
+// string can be a copy of a substring of the reference text (see setReferenceText)
 struct RuleFragment {
+    RuleFragment(): isRule(false), ruleIndex(0), refPos(-1), refLen(0) { }
     bool isRule;
     int ruleIndex;
     string str;
+    int refPos; // position of the string in the reference text, -1 if none
+    // length of the reference read from binary format, the string is 
+    // empty until the reference text is set
+    int refLen;
     //char *str;
 };
 
@@ -36,9 +42,11 @@ public:
     ~CfgRule();
     
     void addFragment(RuleFragment f); 
-    int numFragments();
-    RuleFragment getFragment(int i);    
+    void setFragment(int i, RuleFragment f);
+    int numFragments() const;
+    const RuleFragment& getFragment(int i) const;    
     void deleteFragments();    
+    long getMemoryBytes() const;    
     
 private:    
     
@@ -53,9 +61,24 @@ public:
     virtual ~CfGrammar();
     
     void addRule(int indeks, CfgRule rule);
+    int getNumRules() const;
+    const CfgRule& getRule(int i) const;
     string toString();
     string expand(int rule = 0);    
     void printSize(ostream& out);    
+    int getSize();
+    long getMemoryBytes() const;
+    vector<int> bottomUpOrder() const;
+    bool isValid() const;
+    void renumberByFirstUse();
+    
+    void writeBinary(ostream& out);
+    static CfGrammar* readBinary(istream& in);
+    bool setReferenceText(const string& ref);
+    void setReferenceFingerprint(const string& ref);
+    void copyReferenceFingerprint(const CfGrammar& g);
+    static void writeRuleBinary(ostream& out, const CfgRule& rule);
+    static bool readRuleBinary(istream& in, CfgRule& rule, int numRules);
     
 private:
        
@@ -68,6 +91,13 @@ private:
         
     int numTerms;
     int numNonterms;    
+    int numRefs;
+    
+    // length and fingerprint of the reference text the grammar was 
+    // compressed against, checked by setReferenceText()
+    bool hasRefFingerprint;
+    int refLength;
+    unsigned long long refHash;
     
     void calcSize();
     
@@ -0,0 +1,116 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <libgen.h>
+#include <unistd.h>
+
+#include "CheckpointFile.h"
+
+const unsigned long long CheckpointReader::INITIAL_CHECKSUM = 14695981039346656037ULL;
+
+// FNV-1a checksum extended with bytes of data
+unsigned long long CheckpointReader::update(unsigned long long checksum, const char* data, long bytes) {
+    for (long i = 0; i < bytes; ++i) {
+        checksum ^= (unsigned char)data[i];
+        checksum *= 1099511628211ULL;
+    }
+    return checksum;
+}
+
+CheckpointWriter::CheckpointWriter(const string& p): path(p), tmpPath(p + ".tmp"), 
+        checksum(CheckpointReader::INITIAL_CHECKSUM), buffer(1 << 20), used(0) {
+    fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ok = fd >= 0;
+}
+
+// closes and removes the temporary file if it was not committed
+CheckpointWriter::~CheckpointWriter() {
+    if (fd >= 0) {
+        close(fd);
+        unlink(tmpPath.c_str());
+    }
+}
+
+void CheckpointWriter::flushBuffer() {
+    const char* p = &buffer[0];
+    while (ok && used > 0) {
+        ssize_t written = ::write(fd, p, used);
+        if (written <= 0) ok = false;
+        else { p += written; used -= written; }
+    }
+    used = 0;
+}
+
+void CheckpointWriter::write(const void* data, long bytes) {
+    const char* p = (const char*)data;
+    checksum = CheckpointReader::update(checksum, p, bytes);
+    while (bytes > 0) {
+        long n = min(bytes, (long)buffer.size() - used);
+        memcpy(&buffer[used], p, n);
+        used += n; p += n; bytes -= n;
+        if (used == buffer.size()) flushBuffer();
+    }
+}
+
+// append the checksum, sync the file and rename it to path, 
+// then sync the directory so that the rename is durable
+bool CheckpointWriter::commit() {
+    unsigned long long sum = checksum;
+    write(&sum, sizeof(sum));
+    flushBuffer();
+    if (ok && fsync(fd) != 0) ok = false;
+    if (fd >= 0 && close(fd) != 0) ok = false;
+    fd = -1;
+    if (ok && rename(tmpPath.c_str(), path.c_str()) != 0) ok = false;
+    if (!ok) {
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    vector<char> dir(path.begin(), path.end()); dir.push_back(0);
+    int dirFd = open(dirname(&dir[0]), O_RDONLY);
+    if (dirFd >= 0) { fsync(dirFd); close(dirFd); }
+    return true;
+}
+
+CheckpointReader::CheckpointReader(const string& path): in(path.c_str(), ios::binary) { }
+
+bool CheckpointReader::isOpen() { return in.is_open(); }
+
+bool CheckpointReader::read(void* data, long bytes) {
+    in.read((char*)data, bytes);
+    return in.gcount() == bytes;
+}
+
+// true if the file exists and the checksum at its end matches the data
+bool CheckpointReader::checkFile(const string& path) {
+    ifstream in(path.c_str(), ios::binary);
+    if (!in) return false;
+    in.seekg(0, ios::end);
+    const long size = in.tellg();
+    const long dataSize = size - (long)sizeof(unsigned long long);
+    if (dataSize < 0) return false;
+    in.seekg(0);
+    unsigned long long checksum = INITIAL_CHECKSUM, stored;
+    vector<char> block(1 << 20);
+    for (long left = dataSize; left > 0; ) {
+        long n = min(left, (long)block.size());
+        if (!in.read(&block[0], n)) return false;
+        checksum = update(checksum, &block[0], n);
+        left -= n;
+    }
+    if (!in.read((char*)&stored, sizeof(stored))) return false;
+    return stored == checksum;
+}
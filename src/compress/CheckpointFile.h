@@ -0,0 +1,67 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef CHECKPOINTFILE_H
+#define	CHECKPOINTFILE_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* Binary file replaced atomically and durably. Data is written to path.tmp 
+ * with a running 64 bit FNV-1a checksum appended at the end, the file is 
+ * flushed to disk with fsync and renamed to path, so a crash leaves either 
+ * the previous or the new complete file. */
+class CheckpointWriter {
+public:
+    CheckpointWriter(const string& path);
+    virtual ~CheckpointWriter();
+    
+    void write(const void* data, long bytes);
+    template <typename T> void put(T value) { write(&value, sizeof(T)); }
+    bool commit();
+    
+private:
+    string path, tmpPath;
+    int fd;
+    bool ok;
+    unsigned long long checksum;
+    vector<char> buffer;
+    int used;
+    
+    void flushBuffer();
+    
+};
+
+/* Reader of a file written by CheckpointWriter. Checksum of the whole 
+ * file can be checked before any data is used. */
+class CheckpointReader {
+public:
+    CheckpointReader(const string& path);
+    
+    bool isOpen();
+    bool read(void* data, long bytes);
+    template <typename T> bool get(T& value) { return read(&value, sizeof(T)); }
+    
+    static bool checkFile(const string& path);
+    static unsigned long long update(unsigned long long checksum, const char* data, long bytes);
+    static const unsigned long long INITIAL_CHECKSUM;
+    
+private:
+    ifstream in;
+    
+};
+
+#endif	/* CHECKPOINTFILE_H */
@@ -0,0 +1,37 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <cstdlib>
+
+#include "CompressorWorkspace.h"
+
+CompressorWorkspace::CompressorWorkspace(): suffixArray(0), aux(0), lcp(0), 
+        treeNodes(0), capacity(0) { }
+
+CompressorWorkspace::~CompressorWorkspace() { freeBuffers(); }
+
+// make buffers large enough for a string of length N
+void CompressorWorkspace::reserve(int N) {
+    if (N <= capacity) return;
+    freeBuffers();
+    capacity = N;
+    suffixArray = new int[N+1];
+    aux = new int[N+1];
+    lcp = new int[N+1];
+    treeNodes = (LcpTreeNode *)malloc(N * sizeof(LcpTreeNode));
+}
+
+void CompressorWorkspace::freeBuffers() {
+    delete [] suffixArray; delete [] aux; delete [] lcp;
+    free(treeNodes);
+}
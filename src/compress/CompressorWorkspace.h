@@ -0,0 +1,45 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef COMPRESSORWORKSPACE_H
+#define	COMPRESSORWORKSPACE_H
+
+#include "suffix/LcpTreeCreator.h"
+
+/* Buffers used by LongestFirstSaCompressor, for compressing many strings 
+ * one after the other without allocating suffix structures and rule tables 
+ * for each string. Buffers grow to the size of the largest string. 
+ * Arrays that are not alive at the same time share a buffer: aux array 
+ * for suffix sorting, inverse suffix array and substitution table share 
+ * one buffer, lcp array and the array of sorted interval positions another.
+ * A workspace can be used by only one compressor at a time. */
+class CompressorWorkspace {
+public:
+    CompressorWorkspace();
+    virtual ~CompressorWorkspace();
+    
+    void reserve(int N);
+    
+    int *suffixArray; 
+    int *aux; // aux, inverse suffix array, substitution table
+    int *lcp; // lcp array, sorted positions
+    LcpTreeNode* treeNodes;
+    
+private:    
+    int capacity;
+    
+    void freeBuffers();
+    
+};
+
+#endif	/* COMPRESSORWORKSPACE_H */
@@ -0,0 +1,162 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <iomanip>
+
+#include "DeltaCompressor.h"
+#include "DocumentSetCompressor.h"
+#include "LongestFirstSaCompressor.h"
+#include "util/Profiler.h"
+
+DeltaCompressor::DeltaCompressor(const string& ref, const string& t, CompressorWorkspace* w): 
+        reference(ref), target(t), workspace(w), 
+        numRefs(0), refChars(0), literalChars(0), compressionTime(0) { }
+
+DeltaCompressor::~DeltaCompressor() { }
+
+// return grammar of the target, or 0 if there is no char
+// that can be used as a separator
+CfGrammar* DeltaCompressor::compress() {
+    double startTime = getWallTime();
+    vector<string> docs; docs.push_back(reference); docs.push_back(target);
+    char sep;
+    if (!DocumentSetCompressor::findSeparator(docs, sep)) return 0;
+    const int refLen = reference.size(), targetBegin = refLen + 1;
+    text = reference + sep + target;
+    LongestFirstSaCompressor comp(text.data(), text.size(), false, false, workspace);
+    comp.setSeparator(sep);
+    comp.setTargetStart(targetBegin);
+    CfGrammar* g = comp.compress();
+    GrammarAccess access(g);
+    // split the start rule at the separator, no rule contains it, 
+    // and find positions of the rules in the reference
+    const int numRules = g->getNumRules();
+    vector<int> refPos(numRules, -1);
+    const CfgRule& start = g->getRule(0);
+    CfgRule targetRule;
+    for (int f = 0, pos = 0; f < start.numFragments(); ++f) {
+        const RuleFragment& frag = start.getFragment(f);
+        const int len = frag.isRule ? access.ruleLength(frag.ruleIndex) : frag.str.size();
+        if (pos >= targetBegin) targetRule.addFragment(frag);
+        else if (pos + len <= refLen) {
+            if (frag.isRule) findRefPositions(g, access, frag.ruleIndex, pos, refPos);
+        }
+        else if (pos + len > targetBegin) { // string containing the separator
+            RuleFragment part;
+            part.str = frag.str.substr(targetBegin - pos);
+            targetRule.addFragment(part);
+        }
+        pos += len;
+    }
+    // rules reachable from the target, rules occurring in the reference are leaves
+    vector<int> uses(numRules, 0), reachable;
+    for (int f = 0; f < targetRule.numFragments(); ++f) {
+        const RuleFragment& frag = targetRule.getFragment(f);
+        if (frag.isRule && uses[frag.ruleIndex]++ == 0) reachable.push_back(frag.ruleIndex);
+    }
+    for (int i = 0; i < reachable.size(); ++i) {
+        const int r = reachable[i];
+        if (refPos[r] >= 0) continue;
+        const CfgRule& rule = g->getRule(r);
+        for (int f = 0; f < rule.numFragments(); ++f) {
+            const RuleFragment& frag = rule.getFragment(f);
+            if (frag.isRule && uses[frag.ruleIndex]++ == 0) reachable.push_back(frag.ruleIndex);
+        }
+    }
+    // reference rules used once are inlined as references, other rules kept
+    vector<int> newIndex(numRules, -1);
+    int numKept = 1;
+    for (int i = 0; i < reachable.size(); ++i) {
+        const int r = reachable[i];
+        if (refPos[r] < 0 || uses[r] > 1) newIndex[r] = numKept++;
+    }
+    CfGrammar* grammar = new CfGrammar(numKept);
+    grammar->setReferenceFingerprint(reference);
+    for (int i = -1; i < (int)reachable.size(); ++i) {
+        const int r = i < 0 ? 0 : reachable[i];
+        if (r != 0 && newIndex[r] < 0) continue;
+        CfgRule mapped;
+        if (r != 0 && refPos[r] >= 0) { // reference rule
+            RuleFragment ref; 
+            ref.refPos = refPos[r]; ref.str = reference.substr(refPos[r], access.ruleLength(r));
+            appendFragment(mapped, ref);
+        }
+        else {
+            const CfgRule& rule = r == 0 ? targetRule : g->getRule(r);
+            for (int f = 0; f < rule.numFragments(); ++f) {
+                RuleFragment frag = rule.getFragment(f);
+                if (frag.isRule && newIndex[frag.ruleIndex] >= 0) {
+                    frag.ruleIndex = newIndex[frag.ruleIndex];
+                }
+                else if (frag.isRule) { // inlined reference
+                    RuleFragment ref; 
+                    ref.refPos = refPos[frag.ruleIndex]; 
+                    ref.str = reference.substr(ref.refPos, access.ruleLength(frag.ruleIndex));
+                    frag = ref;
+                }
+                appendFragment(mapped, frag);
+            }
+        }
+        grammar->addRule(r == 0 ? 0 : newIndex[r], mapped);
+    }
+    delete g;
+    // statistics
+    numRefs = refChars = literalChars = 0;
+    for (int r = 0; r < numKept; ++r) {
+        const CfgRule& rule = grammar->getRule(r);
+        for (int f = 0; f < rule.numFragments(); ++f) {
+            const RuleFragment& frag = rule.getFragment(f);
+            if (frag.isRule) continue;
+            if (frag.refPos >= 0) { numRefs++; refChars += frag.str.size(); }
+            else literalChars += frag.str.size();
+        }
+    }
+    compressionTime = getWallTime() - startTime;
+    return grammar;
+}
+
+// set positions in the reference of the rule occurring 
+// in the reference at pos and of all its subrules
+void DeltaCompressor::findRefPositions(CfGrammar* g, GrammarAccess& access, int rule, 
+                                       int pos, vector<int>& refPos) {
+    if (refPos[rule] >= 0) return;
+    refPos[rule] = pos;
+    const CfgRule& r = g->getRule(rule);
+    for (int f = 0; f < r.numFragments(); ++f) {
+        const RuleFragment& frag = r.getFragment(f);
+        if (frag.isRule) findRefPositions(g, access, frag.ruleIndex, pos, refPos);
+        pos += frag.isRule ? access.ruleLength(frag.ruleIndex) : frag.str.size();
+    }
+}
+
+// append fragment to the rule, joining references to adjacent 
+// substrings of the reference
+void DeltaCompressor::appendFragment(CfgRule& rule, const RuleFragment& frag) {
+    const int last = rule.numFragments() - 1;
+    if (frag.refPos >= 0 && last >= 0) {
+        RuleFragment prev = rule.getFragment(last);
+        if (!prev.isRule && prev.refPos >= 0 && prev.refPos + prev.str.size() == frag.refPos) {
+            prev.str += frag.str;
+            rule.setFragment(last, prev);
+            return;
+        }
+    }
+    rule.addFragment(frag);
+}
+
+void DeltaCompressor::printStats(ostream& out) {
+    out << "compression_time: " << setprecision(10) << compressionTime;
+    out << " reference_size: " << reference.size() << " target_size: " << target.size() << endl;
+    out << "references: " << numRefs << " reference_chars: " << refChars;
+    out << " literal_chars: " << literalChars << endl;
+}
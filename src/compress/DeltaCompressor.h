@@ -0,0 +1,61 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef DELTACOMPRESSOR_H
+#define	DELTACOMPRESSOR_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "CfGrammar.h"
+#include "CompressorWorkspace.h"
+#include "GrammarAccess.h"
+
+using namespace std;
+
+/* Compresses a target string against a reference string, typically two 
+ * versions of a file. Suffix structures are built for reference, separator and 
+ * target, and rules are formed only for repeats with an occurrence in the 
+ * target. The resulting grammar encodes the target only: rules whose 
+ * expansion occurs in the reference are replaced by references (position, 
+ * length) into the reference text, contiguous references are joined, and 
+ * rules used once are inlined. Grammar read from binary format must be given 
+ * the reference text by CfGrammar::setReferenceText before expanding, the 
+ * grammar carries a fingerprint of the reference so another text is rejected. */
+class DeltaCompressor {
+public:
+    DeltaCompressor(const string& ref, const string& target, CompressorWorkspace* w = 0);
+    virtual ~DeltaCompressor();
+    
+    CfGrammar* compress();
+    void printStats(ostream& out);
+    
+private:
+    
+    const string& reference;
+    const string& target;
+    CompressorWorkspace* workspace;
+    string text; // reference, separator and target
+    
+    // statistics
+    int numRefs, refChars, literalChars;
+    double compressionTime;
+    
+    void findRefPositions(CfGrammar* g, GrammarAccess& access, int rule, 
+                          int pos, vector<int>& refPos);
+    static void appendFragment(CfgRule& rule, const RuleFragment& frag);
+    
+};
+
+#endif	/* DELTACOMPRESSOR_H */
@@ -0,0 +1,196 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <algorithm>
+#include <iomanip>
+
+#include "DictionaryCompressor.h"
+#include "DocumentSetCompressor.h"
+#include "GrammarAccess.h"
+#include "util/Profiler.h"
+
+// rules of the start rule of the dictionary with 
+// expansion of at least minLength chars are the entries
+DictionaryCompressor::DictionaryCompressor(CfGrammar* dict, int minLen): 
+        minLength(minLen), numMatches(0), matchedChars(0), numGaps(0), compressionTime(0) {
+    if (minLength < 2) minLength = 2;
+    const CfgRule& start = dict->getRule(0);
+    for (int f = 0; f < start.numFragments(); ++f) {
+        const RuleFragment& frag = start.getFragment(f);
+        string s = frag.isRule ? dict->expand(frag.ruleIndex) : frag.str;
+        if (frag.isRule && s.size() >= minLength) {
+            entryPos.push_back(text.size());
+            entryLen.push_back(s.size());
+        }
+        text += s;
+    }
+    numEntries = entryPos.size();
+    buildAutomaton();
+}
+
+DictionaryCompressor::~DictionaryCompressor() { }
+
+// build trie of the entries and fail links breadth first
+void DictionaryCompressor::buildAutomaton() {
+    nodes.assign(1, AcNode());
+    nodes[0].fail = 0; nodes[0].entry = -1; nodes[0].output = -1;
+    for (int e = 0; e < numEntries; ++e) {
+        int node = 0;
+        for (int i = entryPos[e]; i < entryPos[e] + entryLen[e]; ++i) {
+            unsigned char c = text[i];
+            map<unsigned char, int>::iterator it = nodes[node].next.find(c);
+            if (it != nodes[node].next.end()) { node = it->second; continue; }
+            nodes[node].next[c] = nodes.size();
+            node = nodes.size();
+            nodes.push_back(AcNode());
+            nodes[node].fail = 0; nodes[node].entry = -1; nodes[node].output = -1;
+        }
+        nodes[node].entry = e;
+    }
+    vector<int> queue; queue.push_back(0);
+    for (int q = 0; q < queue.size(); ++q) {
+        const int node = queue[q];
+        for (map<unsigned char, int>::iterator it = nodes[node].next.begin(); 
+             it != nodes[node].next.end(); ++it) {
+            const int child = it->second;
+            nodes[child].fail = node == 0 ? 0 : step(nodes[node].fail, it->first);
+            const int fail = nodes[child].fail;
+            nodes[child].output = nodes[fail].entry >= 0 ? fail : nodes[fail].output;
+            queue.push_back(child);
+        }
+    }
+}
+
+// automaton transition, following fail links
+int DictionaryCompressor::step(int node, unsigned char c) {
+    while (true) {
+        map<unsigned char, int>::iterator it = nodes[node].next.find(c);
+        if (it != nodes[node].next.end()) return it->second;
+        if (node == 0) return 0;
+        node = nodes[node].fail;
+    }
+}
+
+// return grammar of the string referencing the dictionary text
+CfGrammar* DictionaryCompressor::compress(const string& s, CompressorWorkspace* workspace) {
+    double start = getWallTime();
+    const int n = s.size();
+    // longest entry starting at each position
+    vector<int> best(n, -1);
+    for (int i = 0, node = 0; i < n; ++i) {
+        node = step(node, s[i]);
+        int out = nodes[node].entry >= 0 ? node : nodes[node].output;
+        for (; out != -1; out = nodes[out].output) {
+            const int e = nodes[out].entry, begin = i - entryLen[e] + 1;
+            if (best[begin] == -1 || entryLen[best[begin]] < entryLen[e]) best[begin] = e;
+        }
+    }
+    // cover greedily by the longest entries, covered substrings 
+    // become references to the dictionary text
+    vector<DocumentSetCompressor::Match> matches;
+    numMatches = matchedChars = 0;
+    for (int i = 0; i < n; ) {
+        if (best[i] == -1) { ++i; continue; }
+        const int e = best[i];
+        DocumentSetCompressor::Match m; m.begin = i; m.length = entryLen[e];
+        m.fragment.refPos = entryPos[e]; m.fragment.str = text.substr(entryPos[e], entryLen[e]);
+        matches.push_back(m);
+        numMatches++; matchedChars += entryLen[e];
+        i += entryLen[e];
+    }
+    CfgRule startRule;
+    vector<CfgRule> gapRules;
+    numGaps = DocumentSetCompressor::spliceGaps(s, matches, map<Fingerprint, int>(), 1, 
+                                                startRule, gapRules, workspace);
+    CfGrammar* grammar = new CfGrammar(gapRules.size() + 1);
+    grammar->setReferenceFingerprint(text);
+    grammar->addRule(0, startRule);
+    for (int r = 0; r < gapRules.size(); ++r) grammar->addRule(r + 1, gapRules[r]);
+    compressionTime = getWallTime() - start;
+    return grammar;
+}
+
+// train dictionary of at most maxSize chars on the samples, return 0 
+// if the samples can not be compressed as a document set
+CfGrammar* DictionaryCompressor::train(const vector<string>& samples, int maxSize, int minLength) {
+    DocumentSetCompressor comp(samples);
+    CfGrammar* g = comp.compress();
+    if (g == 0) return 0;
+    const int D = samples.size(), numRules = g->getNumRules();
+    GrammarAccess access(g);
+    // number of samples containing each rule
+    vector<int> docCount(numRules, 0), lastDoc(numRules, -1), stack;
+    for (int d = 1; d <= D; ++d) {
+        stack.push_back(d);
+        while (stack.empty() == false) {
+            const CfgRule& rule = g->getRule(stack.back()); stack.pop_back();
+            for (int f = 0; f < rule.numFragments(); ++f) {
+                const int c = rule.getFragment(f).ruleIndex;
+                if (!rule.getFragment(f).isRule || lastDoc[c] == d) continue;
+                lastDoc[c] = d; docCount[c]++;
+                stack.push_back(c);
+            }
+        }
+    }
+    // candidates are rules occurring in at least two samples, ordered by 
+    // chars saved if each sample containing a rule references it once 
+    vector<pair<long, int> > candidates;
+    for (int r = D + 1; r < numRules; ++r) {
+        const int len = access.ruleLength(r);
+        if (docCount[r] >= 2 && len >= minLength) {
+            candidates.push_back(make_pair((long)docCount[r] * (len - 2), r));
+        }
+    }
+    sort(candidates.rbegin(), candidates.rend());
+    // select candidates that are not subrules of selected rules
+    vector<char> covered(numRules, 0);
+    vector<string> entries;
+    int size = 0;
+    for (int i = 0; i < candidates.size(); ++i) {
+        const int r = candidates[i].second, len = access.ruleLength(r);
+        if (covered[r] || size + len > maxSize) continue;
+        entries.push_back(g->expand(r));
+        size += len;
+        stack.push_back(r);
+        while (stack.empty() == false) {
+            const CfgRule& rule = g->getRule(stack.back()); stack.pop_back();
+            for (int f = 0; f < rule.numFragments(); ++f) {
+                const int c = rule.getFragment(f).ruleIndex;
+                if (!rule.getFragment(f).isRule || covered[c]) continue;
+                covered[c] = 1;
+                stack.push_back(c);
+            }
+        }
+    }
+    delete g;
+    CfGrammar* dict = new CfGrammar(entries.size() + 1);
+    CfgRule start;
+    for (int e = 0; e < entries.size(); ++e) {
+        RuleFragment ref; ref.isRule = true; ref.ruleIndex = e + 1;
+        start.addFragment(ref);
+        CfgRule entry; RuleFragment str; str.str = entries[e];
+        entry.addFragment(str);
+        dict->addRule(e + 1, entry);
+    }
+    dict->addRule(0, start);
+    return dict;
+}
+
+const string& DictionaryCompressor::getText() { return text; }
+
+void DictionaryCompressor::printStats(ostream& out) {
+    out << "compression_time: " << setprecision(10) << compressionTime;
+    out << " dictionary_entries: " << numEntries << " dictionary_size: " << text.size() << endl;
+    out << "matches: " << numMatches << " matched_chars: " << matchedChars;
+    out << " gaps: " << numGaps << endl;
+}
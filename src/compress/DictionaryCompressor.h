@@ -0,0 +1,73 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef DICTIONARYCOMPRESSOR_H
+#define	DICTIONARYCOMPRESSOR_H
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "CfGrammar.h"
+#include "CompressorWorkspace.h"
+
+using namespace std;
+
+/* Compresses strings using a dictionary of rule expansions trained on a sample 
+ * of similar strings. The dictionary is a grammar whose start rule is the 
+ * concatenation of the entries, each rule in the start rule being an entry.
+ * Training compresses the samples as a document set and selects the longest 
+ * shared rules occurring in the most samples. Occurrences of the entries in 
+ * the compressed string are found by Aho-Corasick automaton and covered 
+ * greedily by the longest entry, covered substrings become references to the
+ * dictionary text (see CfGrammar::setReferenceText), and only the gaps between
+ * them are compressed longest first, together as a document set. The grammar 
+ * carries a fingerprint of the dictionary text, so loading it with another 
+ * dictionary fails. */
+class DictionaryCompressor {
+public:
+    DictionaryCompressor(CfGrammar* dict, int minLength = 8);
+    virtual ~DictionaryCompressor();
+    
+    CfGrammar* compress(const string& s, CompressorWorkspace* w = 0);
+    const string& getText();
+    void printStats(ostream& out);
+    
+    static CfGrammar* train(const vector<string>& samples, int maxSize, int minLength = 8);
+    
+private:
+    
+    int minLength;
+    string text; // concatenated entries
+    vector<int> entryPos, entryLen;
+    
+    // Aho-Corasick automaton of the entries, node 0 is the root
+    struct AcNode {
+        map<unsigned char, int> next;
+        int fail;
+        int entry; // entry ending at the node, -1 if none
+        int output; // nearest node on the fail path with an entry, -1 if none
+    };
+    vector<AcNode> nodes;
+    
+    // statistics
+    int numMatches, matchedChars, numGaps, numEntries;
+    double compressionTime;
+    
+    void buildAutomaton();
+    int step(int node, unsigned char c);
+    
+};
+
+#endif	/* DICTIONARYCOMPRESSOR_H */
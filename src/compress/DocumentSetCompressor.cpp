@@ -0,0 +1,211 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <iomanip>
+
+#include "DocumentSetCompressor.h"
+
+DocumentSetCompressor::DocumentSetCompressor(const vector<string>& docs, CompressorWorkspace* w): 
+        documents(docs), workspace(w), compressor(0) { }
+
+DocumentSetCompressor::~DocumentSetCompressor() {
+    delete compressor;
+}
+
+// find a char that occurs in no document, return false if there is no such char
+bool DocumentSetCompressor::findSeparator(const vector<string>& docs, char& sep) {
+    vector<bool> used(256, false);
+    for (int i = 0; i < docs.size(); ++i) {
+        for (int j = 0; j < docs[i].size(); ++j) used[(unsigned char)docs[i][j]] = true;
+    }
+    for (int c = 0; c < 256; ++c) {
+        if (!used[c]) { sep = (char)c; return true; }
+    }
+    return false;
+}
+
+// compress documents, return grammar with R0 = [R1]...[Rd] where 
+// Ri is the start rule of the i-th document, or 0 if there 
+// is no char that can be used as a separator
+CfGrammar* DocumentSetCompressor::compress() {
+    vector<CfgRule> docs;
+    CfGrammar* shared = compressToFragments(docs);
+    if (shared == 0) return 0;
+    const int D = docs.size(), numShared = shared->getNumRules();
+    // shift shared rules after the document rules
+    vector<int> ruleMap(numShared);
+    for (int r = 1; r < numShared; ++r) ruleMap[r] = r + D;
+    CfGrammar* grammar = new CfGrammar(numShared + D);
+    CfgRule start;
+    for (int d = 0; d < D; ++d) {
+        RuleFragment frag; frag.isRule = true; frag.ruleIndex = d + 1;
+        start.addFragment(frag);
+        CfgRule doc;
+        for (int f = 0; f < docs[d].numFragments(); ++f) {
+            RuleFragment frag = docs[d].getFragment(f);
+            if (frag.isRule) frag.ruleIndex = ruleMap[frag.ruleIndex];
+            doc.addFragment(frag);
+        }
+        grammar->addRule(d + 1, doc);
+    }
+    grammar->addRule(0, start);
+    for (int r = 1; r < numShared; ++r) {
+        const CfgRule& rule = shared->getRule(r);
+        CfgRule mapped;
+        for (int f = 0; f < rule.numFragments(); ++f) {
+            RuleFragment frag = rule.getFragment(f);
+            if (frag.isRule) frag.ruleIndex = ruleMap[frag.ruleIndex];
+            mapped.addFragment(frag);
+        }
+        grammar->addRule(ruleMap[r], mapped);
+    }
+    delete shared;
+    return grammar;
+}
+
+// compress documents, return grammar with shared rules and empty R0, 
+// fragments of the documents are stored in docFragments.
+// return 0 if there is no char that can be used as a separator
+CfGrammar* DocumentSetCompressor::compressToFragments(vector<CfgRule>& docFragments) {
+    char sep;
+    if (!findSeparator(documents, sep)) return 0;
+    text.clear();
+    for (int i = 0; i < documents.size(); ++i) {
+        if (i > 0) text += sep;
+        text += documents[i];
+    }
+    delete compressor;
+    compressor = new LongestFirstSaCompressor(text.data(), text.size(), false, false, workspace);
+    compressor->setSeparator(sep);
+    CfGrammar* grammar = compressor->compress();
+    // split start rule at the separators
+    docFragments.assign(documents.size(), CfgRule());
+    const CfgRule& start = grammar->getRule(0);
+    int doc = 0;
+    for (int f = 0; f < start.numFragments(); ++f) {
+        const RuleFragment& frag = start.getFragment(f);
+        if (frag.isRule) { 
+            docFragments[doc].addFragment(frag); 
+            continue; 
+        }
+        size_t begin = 0;
+        while (true) {
+            size_t end = frag.str.find(sep, begin);
+            if (end == string::npos) end = frag.str.size();
+            if (end > begin) {
+                RuleFragment part; part.isRule = false;
+                part.str = frag.str.substr(begin, end - begin);
+                docFragments[doc].addFragment(part);
+            }
+            if (end == frag.str.size()) break;
+            doc++; begin = end + 1;
+        }
+    }
+    grammar->addRule(0, CfgRule());
+    return grammar;
+}
+
+// append fragments to the rule, adjacent plain strings are merged
+static void appendFragments(CfgRule& rule, const CfgRule& fragments) {
+    for (int f = 0; f < fragments.numFragments(); ++f) {
+        const RuleFragment& frag = fragments.getFragment(f);
+        const int last = rule.numFragments() - 1;
+        if (!frag.isRule && frag.refPos < 0 && last >= 0 && 
+            !rule.getFragment(last).isRule && rule.getFragment(last).refPos < 0) {
+            RuleFragment merged = rule.getFragment(last);
+            merged.str += frag.str;
+            rule.setFragment(last, merged);
+        }
+        else rule.addFragment(frag);
+    }
+}
+
+// copy of the rule with rule indexes replaced by mapped indexes
+static CfgRule mapRule(const CfgRule& rule, const vector<int>& ruleMap) {
+    CfgRule result;
+    for (int f = 0; f < rule.numFragments(); ++f) {
+        RuleFragment frag = rule.getFragment(f);
+        if (frag.isRule) frag.ruleIndex = ruleMap[frag.ruleIndex];
+        result.addFragment(frag);
+    }
+    return result;
+}
+
+// append s to startRule with the matches, ordered and not overlapping, replaced 
+// by their fragments, and compress the gaps between them with shared rules, as 
+// plain strings if that fails. A rule of the gaps with the fingerprint of one 
+// of the rules is replaced by it, the others are appended to newRules and 
+// numbered from firstRule, subrules before the rules containing them. 
+// Return the number of gaps
+int DocumentSetCompressor::spliceGaps(const string& s, const vector<Match>& matches, 
+                                      const map<Fingerprint, int>& rules, int firstRule, 
+                                      CfgRule& startRule, vector<CfgRule>& newRules, 
+                                      CompressorWorkspace* w) {
+    vector<string> gaps;
+    for (int m = 0, gapBegin = 0; m <= matches.size(); ++m) {
+        const int gapEnd = m < matches.size() ? matches[m].begin : s.size();
+        if (gapBegin < gapEnd) gaps.push_back(s.substr(gapBegin, gapEnd - gapBegin));
+        if (m < matches.size()) gapBegin = matches[m].begin + matches[m].length;
+    }
+    DocumentSetCompressor gapCompressor(gaps, w);
+    vector<CfgRule> gapFragments;
+    CfGrammar* gapGrammar = gapCompressor.compressToFragments(gapFragments);
+    vector<int> gapMap;
+    if (gapGrammar != 0) {
+        vector<Fingerprint> gapFp = GrammarFingerprint::ofRules(gapGrammar);
+        map<Fingerprint, int> added;
+        gapMap.assign(gapGrammar->getNumRules(), -1);
+        vector<int> order = gapGrammar->bottomUpOrder();
+        for (int i = 0; i < order.size(); ++i) {
+            const int r = order[i];
+            if (r == 0) continue;
+            map<Fingerprint, int>::const_iterator it = rules.find(gapFp[r]);
+            if (it != rules.end()) gapMap[r] = it->second;
+            else if ((it = added.find(gapFp[r])) != added.end()) gapMap[r] = it->second;
+            else {
+                gapMap[r] = firstRule + newRules.size();
+                added[gapFp[r]] = gapMap[r];
+                newRules.push_back(mapRule(gapGrammar->getRule(r), gapMap));
+            }
+        }
+    }
+    for (int m = 0, gapBegin = 0, g = 0; m <= matches.size(); ++m) {
+        const int gapEnd = m < matches.size() ? matches[m].begin : s.size();
+        if (gapBegin < gapEnd) {
+            CfgRule gap;
+            if (gapGrammar != 0) gap = mapRule(gapFragments[g], gapMap);
+            else {
+                RuleFragment frag; frag.str = gaps[g];
+                gap.addFragment(frag);
+            }
+            appendFragments(startRule, gap);
+            g++;
+        }
+        if (m == matches.size()) break;
+        CfgRule match;
+        match.addFragment(matches[m].fragment);
+        appendFragments(startRule, match);
+        gapBegin = matches[m].begin + matches[m].length;
+    }
+    delete gapGrammar;
+    return gaps.size();
+}
+
+void DocumentSetCompressor::printStats(ostream& out) {
+    out << "num_documents: " << documents.size();
+    if (compressor != 0) {
+        out << " compression_time: " << setprecision(10) << compressor->getCompressionTime() << endl;
+        compressor->printStats(out);
+    }
+    else out << endl;
+}
@@ -0,0 +1,66 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef DOCUMENTSETCOMPRESSOR_H
+#define	DOCUMENTSETCOMPRESSOR_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "CfGrammar.h"
+#include "CompressorWorkspace.h"
+#include "GrammarFingerprint.h"
+#include "LongestFirstSaCompressor.h"
+
+using namespace std;
+
+/* Compresses a set of documents with one shared set of rules. Documents are 
+ * concatenated with a separator char that occurs in no document, suffix 
+ * structures are built once for the concatenation and the separator is 
+ * treated as unique at each position so no rule spans two documents. 
+ * In the resulting grammar rule i, 1 <= i <= number of documents, is the start 
+ * rule of i-th document, and R0 is concatenation of all the documents, so each
+ * document can be extracted without expanding the others. */
+class DocumentSetCompressor {
+public:
+    DocumentSetCompressor(const vector<string>& docs, CompressorWorkspace* w = 0);
+    virtual ~DocumentSetCompressor();
+    
+    CfGrammar* compress();
+    CfGrammar* compressToFragments(vector<CfgRule>& docFragments);
+    void printStats(ostream& out);
+    
+    static bool findSeparator(const vector<string>& docs, char& sep);
+    
+    // fragment (rule or reference) replacing length chars at position begin
+    struct Match {
+        int begin, length;
+        RuleFragment fragment;
+    };
+    static int spliceGaps(const string& s, const vector<Match>& matches, 
+                          const map<Fingerprint, int>& rules, int firstRule, 
+                          CfgRule& startRule, vector<CfgRule>& newRules, 
+                          CompressorWorkspace* w = 0);
+    
+private:
+    
+    const vector<string>& documents;
+    CompressorWorkspace* workspace;
+    LongestFirstSaCompressor* compressor;
+    string text; // concatenated documents
+    
+};
+
+#endif	/* DOCUMENTSETCOMPRESSOR_H */
@@ -0,0 +1,107 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <algorithm>
+
+#include "GrammarAccess.h"
+
+GrammarAccess::GrammarAccess(CfGrammar* g): grammar(g), built(false) { }
+
+// calculate rule lengths and fragment offsets, rules are visited bottom up 
+// so lengths of all the subrules are known when a rule is processed
+void GrammarAccess::build() {
+    const int numRules = grammar->getNumRules();
+    fragBase.resize(numRules+1);
+    fragBase[0] = 0;
+    for (int r = 0; r < numRules; ++r) 
+        fragBase[r+1] = fragBase[r] + grammar->getRule(r).numFragments();
+    fragStart.resize(fragBase[numRules]);
+    ruleLen.resize(numRules);
+    vector<int> order = grammar->bottomUpOrder();
+    for (int i = 0; i < order.size(); ++i) {
+        int r = order[i];
+        const CfgRule& rule = grammar->getRule(r);
+        int len = 0;
+        for (int f = 0; f < rule.numFragments(); ++f) {
+            fragStart[fragBase[r] + f] = len;
+            const RuleFragment& frag = rule.getFragment(f);
+            if (frag.isRule) len += ruleLen[frag.ruleIndex];
+            else len += frag.str.size();
+        }
+        ruleLen[r] = len;
+    }
+    built = true;
+}
+
+// length of the string encoded by the grammar
+int GrammarAccess::length() { return ruleLength(0); }
+
+// length of the expansion of the rule
+int GrammarAccess::ruleLength(int rule) {
+    if (!built) build();
+    return ruleLen[rule];
+}
+
+// offset of the fragment within the expansion of the rule
+int GrammarAccess::fragmentStart(int rule, int frag) {
+    if (!built) build();
+    return fragStart[fragBase[rule] + frag];
+}
+
+// index of the fragment of the rule that contains 
+// given offset within the expansion of the rule
+int GrammarAccess::findFragment(int rule, int offset) {
+    if (!built) build();
+    vector<int>::iterator b = fragStart.begin() + fragBase[rule];
+    vector<int>::iterator e = fragStart.begin() + fragBase[rule+1];
+    return (upper_bound(b, e, offset) - b) - 1;
+}
+
+// extract substring of the expanded string starting at offset, of length len
+// range is clipped to the expanded string
+string GrammarAccess::extract(int offset, int len) {
+    if (!built) build();
+    string result;
+    if (offset < 0) { len += offset; offset = 0; }
+    if (len > ruleLen[0] - offset) len = ruleLen[0] - offset;
+    if (len <= 0) return result;
+    result.reserve(len);
+    extractRule(0, offset, len, result);
+    return result;
+}
+
+// extract substrings for a batch of ranges
+vector<string> GrammarAccess::extract(const vector<AccessRange>& ranges) {
+    vector<string> result(ranges.size());
+    for (int i = 0; i < ranges.size(); ++i) {
+        result[i] = extract(ranges[i].offset, ranges[i].length);
+    }
+    return result;
+}
+
+// append len characters of the expansion of the rule, starting at offset, 
+// to out. range must be within the expansion of the rule
+void GrammarAccess::extractRule(int rule, int offset, int len, string& out) {
+    const CfgRule& r = grammar->getRule(rule);
+    const int base = fragBase[rule];
+    for (int f = findFragment(rule, offset); len > 0; ++f) {
+        const RuleFragment& frag = r.getFragment(f);
+        // offset within the fragment and number of characters it contributes
+        int foff = offset - fragStart[base + f];
+        int flen = frag.isRule ? ruleLen[frag.ruleIndex] : frag.str.size();
+        int l = min(flen - foff, len);
+        if (frag.isRule) extractRule(frag.ruleIndex, foff, l, out);
+        else out.append(frag.str, foff, l);
+        offset += l; len -= l;
+    }
+}
@@ -0,0 +1,63 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef GRAMMARACCESS_H
+#define	GRAMMARACCESS_H
+
+#include <string>
+#include <vector>
+
+#include "CfGrammar.h"
+
+using namespace std;
+
+// range of the expanded string, for batch extraction
+struct AccessRange {
+    int offset, length;
+};
+
+/* Random access to the string encoded by a grammar, without full expansion. 
+ * Expansion lengths of the rules and prefix sums of fragment lengths are 
+ * calculated on first access, substring (offset, len) is then extracted 
+ * by descending the grammar in O(height + len). 
+ * The grammar must not be changed while the access object is used. */
+class GrammarAccess {
+public:
+    GrammarAccess(CfGrammar* g);
+    
+    string extract(int offset, int len);
+    vector<string> extract(const vector<AccessRange>& ranges);
+    
+    int length();    
+    int ruleLength(int rule);
+    int fragmentStart(int rule, int frag);
+    int findFragment(int rule, int offset);
+    
+private:
+    
+    CfGrammar* grammar;
+    bool built;
+    
+    // expansion length of each rule
+    vector<int> ruleLen;
+    // fragStart[fragBase[r] + i] is offset of i-th fragment 
+    // of rule r within the expansion of r
+    vector<int> fragBase;
+    vector<int> fragStart;
+    
+    void build();
+    void extractRule(int rule, int offset, int len, string& out);
+    
+};
+
+#endif	/* GRAMMARACCESS_H */
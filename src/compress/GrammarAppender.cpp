@@ -0,0 +1,103 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <algorithm>
+#include <iomanip>
+
+#include "GrammarAppender.h"
+#include "DocumentSetCompressor.h"
+#include "util/Profiler.h"
+
+GrammarAppender::GrammarAppender(CfGrammar* g, int maxLen, int minLen): 
+        grammar(g), maxLengths(maxLen), minLength(minLen), tailLength(0), 
+        matchedChars(0), numMatches(0), numGaps(0), numNewRules(0), appendTime(0) {
+    if (minLength < 2) minLength = 2;
+    buildIndex();
+}
+
+GrammarAppender::~GrammarAppender() { }
+
+// index the rules whose expansion lengths are among the maxLengths lengths 
+// covering the most chars with rules, counting each expansion once
+void GrammarAppender::buildIndex() {
+    ruleFp = GrammarFingerprint::ofRules(grammar);
+    map<int, long> coverage; // expansion length -> chars in distinct expansions 
+    for (int r = 1; r < grammar->getNumRules(); ++r) {
+        if (allRules.count(ruleFp[r]) == 0) allRules[ruleFp[r]] = r;
+        if (ruleFp[r].length >= minLength) coverage[ruleFp[r].length] += ruleFp[r].length;
+    }
+    vector<pair<long, int> > byCoverage;
+    for (map<int, long>::iterator it = coverage.begin(); it != coverage.end(); ++it) {
+        byCoverage.push_back(make_pair(it->second, it->first));
+    }
+    sort(byCoverage.rbegin(), byCoverage.rend());
+    for (int i = 0; i < byCoverage.size() && i < maxLengths; ++i) lengths.push_back(byCoverage[i].second);
+    sort(lengths.rbegin(), lengths.rend());
+    for (int i = 0; i < lengths.size(); ++i) lengthPow.push_back(GrammarFingerprint::power(lengths[i]));
+    for (int r = 1; r < grammar->getNumRules(); ++r) {
+        if (binary_search(lengths.rbegin(), lengths.rend(), ruleFp[r].length)) index[ruleFp[r]] = r;
+    }
+}
+
+// return new grammar encoding the string of the grammar followed by tail
+CfGrammar* GrammarAppender::append(const string& tail, CompressorWorkspace* workspace) {
+    double start = getWallTime();
+    typedef GrammarFingerprint GF;
+    const int n = tail.size();
+    tailLength = n;
+    // prefix[i] is fingerprint hash of the first i chars of tail
+    vector<unsigned long long> prefix(n + 1, 0);
+    for (int i = 0; i < n; ++i) {
+        prefix[i+1] = GF::addMod(GF::mulMod(prefix[i], GF::BASE), (unsigned char)tail[i] + 1);
+    }
+    // cover the tail greedily by the longest matching rule
+    vector<DocumentSetCompressor::Match> matches;
+    for (int i = 0; i < n; ) {
+        int match = 0, len = 0;
+        for (int l = 0; l < lengths.size() && match == 0; ++l) {
+            if (lengths[l] > n - i) continue;
+            Fingerprint f; f.length = lengths[l];
+            f.hash = GF::addMod(prefix[i + f.length], GF::PRIME - GF::mulMod(prefix[i], lengthPow[l]));
+            map<Fingerprint, int>::iterator it = index.find(f);
+            if (it != index.end()) { match = it->second; len = f.length; }
+        }
+        if (match == 0) { ++i; continue; }
+        DocumentSetCompressor::Match m; m.begin = i; m.length = len;
+        m.fragment.isRule = true; m.fragment.ruleIndex = match;
+        matches.push_back(m);
+        numMatches++; matchedChars += len;
+        i += len;
+    }
+    // extend the start rule, rules of the gaps not equal to an existing rule 
+    // follow the existing rules
+    const int oldRules = grammar->getNumRules();
+    CfgRule startRule = grammar->getRule(0);
+    vector<CfgRule> newRules;
+    numGaps = DocumentSetCompressor::spliceGaps(tail, matches, allRules, oldRules, 
+                                                startRule, newRules, workspace);
+    numNewRules = newRules.size();
+    CfGrammar* result = new CfGrammar(oldRules + newRules.size());
+    result->addRule(0, startRule);
+    for (int r = 1; r < oldRules; ++r) result->addRule(r, grammar->getRule(r));
+    for (int r = 0; r < newRules.size(); ++r) result->addRule(oldRules + r, newRules[r]);
+    appendTime = getWallTime() - start;
+    return result;
+}
+
+void GrammarAppender::printStats(ostream& out) {
+    out << "append_time: " << setprecision(10) << appendTime;
+    out << " tail_length: " << tailLength << " indexed_rules: " << index.size();
+    out << " indexed_lengths: " << lengths.size() << endl;
+    out << "matched_chars: " << matchedChars << " matches: " << numMatches;
+    out << " gaps: " << numGaps << " new_rules: " << numNewRules << endl;
+}
@@ -0,0 +1,66 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef GRAMMARAPPENDER_H
+#define	GRAMMARAPPENDER_H
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "CfGrammar.h"
+#include "CompressorWorkspace.h"
+#include "GrammarFingerprint.h"
+
+using namespace std;
+
+/* Appends a string to the string encoded by a grammar, reusing the rules of 
+ * the grammar. Expansions of the rules are indexed by fingerprint for a 
+ * bounded number of expansion lengths, and the appended string is greedily 
+ * covered, longest first, by substrings matching some rule expansion. 
+ * Gaps between the matches are compressed together as a document set and 
+ * only their rules are matched against the fingerprints of the existing 
+ * rules, which are computed once when the appender is created. Rules of the
+ * grammar keep their indexes and are copied to the result, apart from the 
+ * copy the cost of append depends only on the length of the appended string.
+ * Matches are found by fingerprints only, equality of the matched strings 
+ * is not checked. */
+class GrammarAppender {
+public:
+    GrammarAppender(CfGrammar* g, int maxLengths = 32, int minLength = 4);
+    virtual ~GrammarAppender();
+    
+    CfGrammar* append(const string& tail, CompressorWorkspace* w = 0);
+    void printStats(ostream& out);
+    
+private:
+    
+    CfGrammar* grammar;
+    int maxLengths, minLength;
+    
+    vector<Fingerprint> ruleFp;
+    map<Fingerprint, int> allRules; // all the rules by fingerprint of expansion
+    map<Fingerprint, int> index; // indexed rules by fingerprint of expansion
+    vector<int> lengths; // indexed expansion lengths, descending
+    vector<unsigned long long> lengthPow; // BASE^length for indexed lengths
+    
+    // statistics
+    int tailLength, matchedChars, numMatches, numGaps, numNewRules;
+    double appendTime;
+    
+    void buildIndex();
+    
+};
+
+#endif	/* GRAMMARAPPENDER_H */
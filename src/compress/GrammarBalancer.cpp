@@ -0,0 +1,191 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <algorithm>
+
+#include "GrammarBalancer.h"
+
+GrammarBalancer::GrammarBalancer(): heightBefore(0), heightAfter(0), 
+        rulesBefore(0), rulesAfter(0), sizeBefore(0), sizeAfter(0) { }
+
+// create balanced grammar expanding to the same string as g
+CfGrammar* GrammarBalancer::balance(CfGrammar* g) {
+    nodes.clear(); leaves.clear();
+    const int numRules = g->getNumRules();
+    // AVL grammar node corresponding to each original rule
+    vector<int> ruleNode(numRules, -1);
+    vector<int> order = g->bottomUpOrder();
+    for (int i = 0; i < order.size(); ++i) {
+        const int r = order[i];
+        const CfgRule& rule = g->getRule(r);
+        int node = -1;
+        for (int f = 0; f < rule.numFragments(); ++f) {
+            const RuleFragment& frag = rule.getFragment(f);
+            int next;
+            if (frag.isRule) next = ruleNode[frag.ruleIndex];
+            else {
+                if (frag.str.empty()) continue;
+                next = createLeaf(frag.str);
+            }
+            if (node == -1) node = next;
+            else node = join(node, next);
+        }
+        if (node == -1) node = createLeaf(""); // empty rule
+        ruleNode[r] = node;
+    }
+    CfGrammar* result = createGrammar(ruleNode[0]);
+    
+    heightBefore = grammarHeight(g); heightAfter = grammarHeight(result);
+    rulesBefore = numRules; rulesAfter = result->getNumRules();
+    sizeBefore = g->getSize(); sizeAfter = result->getSize();
+    nodes.clear(); leaves.clear();
+    return result;
+}
+
+int GrammarBalancer::createLeaf(const string& s) {
+    Node n; n.left = leaves.size(); n.right = -1; n.height = 0;
+    leaves.push_back(s);
+    nodes.push_back(n);
+    return nodes.size() - 1;
+}
+
+int GrammarBalancer::createNode(int left, int right) {
+    Node n; n.left = left; n.right = right; 
+    n.height = max(height(left), height(right)) + 1;
+    nodes.push_back(n);
+    return nodes.size() - 1;
+}
+
+// create AVL grammar node expanding to concatenation of expansions of a and b
+int GrammarBalancer::join(int a, int b) {
+    if (height(a) > height(b) + 1) {
+        int r = join(nodes[a].right, b);
+        return rebalance(nodes[a].left, r);
+    }
+    else if (height(b) > height(a) + 1) {
+        int l = join(a, nodes[b].left);
+        return rebalance(l, nodes[b].right);
+    }
+    else return createNode(a, b);
+}
+
+// create node with children l and r whose heights differ 
+// by at most 2, rotate if they differ by 2
+int GrammarBalancer::rebalance(int l, int r) {
+    if (height(l) > height(r) + 1) {
+        const Node ln = nodes[l];
+        if (height(ln.left) >= height(ln.right)) {
+            return createNode(ln.left, createNode(ln.right, r));
+        }
+        else {
+            const Node lr = nodes[ln.right];
+            int nl = createNode(ln.left, lr.left);
+            return createNode(nl, createNode(lr.right, r));
+        }
+    }
+    else if (height(r) > height(l) + 1) {
+        const Node rn = nodes[r];
+        if (height(rn.right) >= height(rn.left)) {
+            return createNode(createNode(l, rn.left), rn.right);
+        }
+        else {
+            const Node rl = nodes[rn.left];
+            int nl = createNode(l, rl.left);
+            return createNode(nl, createNode(rl.right, rn.right));
+        }
+    }
+    else return createNode(l, r);
+}
+
+// create grammar with a rule for each inner node reachable from the root
+CfGrammar* GrammarBalancer::createGrammar(int root) {
+    // number reachable inner nodes in depth first order, root gets 0
+    vector<int> ruleIndex(nodes.size(), -1);
+    vector<int> inner, stack;
+    stack.push_back(root);
+    while (stack.empty() == false) {
+        int n = stack.back(); stack.pop_back();
+        if (ruleIndex[n] != -1) continue;
+        ruleIndex[n] = inner.size();
+        inner.push_back(n);
+        if (nodes[n].isLeaf()) continue;
+        stack.push_back(nodes[n].right);
+        stack.push_back(nodes[n].left);
+    }
+    if (nodes[root].isLeaf()) { // whole string is one leaf
+        CfGrammar* grammar = new CfGrammar(1);
+        CfgRule rule;
+        addChild(rule, root, ruleIndex);
+        grammar->addRule(0, rule);
+        return grammar;
+    }
+    // leaves are not rules, renumber inner nodes only
+    int numRules = 0;
+    for (int i = 0; i < inner.size(); ++i) {
+        if (nodes[inner[i]].isLeaf()) ruleIndex[inner[i]] = -1;
+        else ruleIndex[inner[i]] = numRules++;
+    }
+    CfGrammar* grammar = new CfGrammar(numRules);
+    for (int i = 0; i < inner.size(); ++i) {
+        const int n = inner[i];
+        if (nodes[n].isLeaf()) continue;
+        CfgRule rule;
+        const int l = nodes[n].left, r = nodes[n].right;
+        if (nodes[l].isLeaf() && nodes[r].isLeaf()) { // merge two strings
+            RuleFragment frag; frag.isRule = false;
+            frag.str = leaves[nodes[l].left] + leaves[nodes[r].left];
+            rule.addFragment(frag);
+        }
+        else {
+            addChild(rule, l, ruleIndex);
+            addChild(rule, r, ruleIndex);
+        }
+        grammar->addRule(ruleIndex[n], rule);
+    }
+    return grammar;
+}
+
+// add node as a fragment of the rule, leaf is added as a string
+void GrammarBalancer::addChild(CfgRule& rule, int child, const vector<int>& ruleIndex) {
+    RuleFragment frag;
+    if (nodes[child].isLeaf()) {
+        frag.isRule = false; frag.str = leaves[nodes[child].left];
+        if (frag.str.empty()) return;
+    }
+    else {
+        frag.isRule = true; frag.ruleIndex = ruleIndex[child];
+    }
+    rule.addFragment(frag);
+}
+
+// height of the grammar, the rule containing only terminals has height 1
+int GrammarBalancer::grammarHeight(CfGrammar* g) {
+    vector<int> h(g->getNumRules(), 0);
+    vector<int> order = g->bottomUpOrder();
+    for (int i = 0; i < order.size(); ++i) {
+        const CfgRule& rule = g->getRule(order[i]);
+        int maxh = 0;
+        for (int f = 0; f < rule.numFragments(); ++f) {
+            const RuleFragment& frag = rule.getFragment(f);
+            if (frag.isRule && h[frag.ruleIndex] > maxh) maxh = h[frag.ruleIndex];
+        }
+        h[order[i]] = maxh + 1;
+    }
+    return h[0];
+}
+
+void GrammarBalancer::printStats(ostream& out) {
+    out << "height_before_balance: " << heightBefore << " height_after_balance: " << heightAfter;
+    out << " rules_before_balance: " << rulesBefore << " rules_after_balance: " << rulesAfter;
+    out << " size_before_balance: " << sizeBefore << " size_after_balance: " << sizeAfter << endl;
+}
@@ -0,0 +1,67 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef GRAMMARBALANCER_H
+#define	GRAMMARBALANCER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "CfGrammar.h"
+
+using namespace std;
+
+/* Transforms a grammar to an equivalent AVL grammar with binary rules, 
+ * its height is at most 1.44 log(N) where N is the length of the expansion. 
+ * Rules are processed bottom up, right side of each rule is built by 
+ * concatenating AVL grammars of the fragments. Concatenation of grammars 
+ * of heights h1 and h2 creates O(|h1-h2|+1) new rules along the spine 
+ * of the higher grammar and rebalances it with rotations, existing rules 
+ * are never modified so they can be shared by all the rules using them. */
+class GrammarBalancer {
+public:
+    GrammarBalancer();
+    
+    CfGrammar* balance(CfGrammar* g);
+    void printStats(ostream& out);
+    
+    static int grammarHeight(CfGrammar* g);
+    
+private:
+    
+    // leaf holds a string fragment and has height 0, 
+    // inner node is a binary rule
+    struct Node {
+        int left, right; // child nodes, for a leaf left is index of the string
+        int height;
+        inline bool isLeaf() { return height == 0; }
+    };
+    
+    vector<Node> nodes;
+    vector<string> leaves;
+    
+    // statistics of the last balancing
+    int heightBefore, heightAfter, rulesBefore, rulesAfter, sizeBefore, sizeAfter;
+    
+    int createLeaf(const string& s);
+    int createNode(int left, int right);
+    int join(int a, int b);
+    int rebalance(int l, int r);
+    inline int height(int node) { return nodes[node].height; }
+    CfGrammar* createGrammar(int root);
+    void addChild(CfgRule& rule, int child, const vector<int>& ruleIndex);
+    
+};
+
+#endif	/* GRAMMARBALANCER_H */
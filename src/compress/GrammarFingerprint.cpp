@@ -0,0 +1,85 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include "GrammarFingerprint.h"
+
+const unsigned long long GrammarFingerprint::PRIME = (1ULL << 61) - 1;
+const unsigned long long GrammarFingerprint::BASE = 1000003;
+
+unsigned long long GrammarFingerprint::mulMod(unsigned long long a, unsigned long long b) {
+    unsigned __int128 p = (unsigned __int128)a * b;
+    // for a, b < PRIME the sum of the parts is below 2 * PRIME
+    unsigned long long r = (unsigned long long)(p & PRIME) + (unsigned long long)(p >> 61);
+    return r >= PRIME ? r - PRIME : r;
+}
+
+unsigned long long GrammarFingerprint::addMod(unsigned long long a, unsigned long long b) {
+    unsigned long long r = a + b;
+    return r >= PRIME ? r - PRIME : r;
+}
+
+// BASE^exp modulo PRIME
+unsigned long long GrammarFingerprint::power(int exp) {
+    unsigned long long result = 1, b = BASE;
+    while (exp > 0) {
+        if (exp & 1) result = mulMod(result, b);
+        b = mulMod(b, b);
+        exp >>= 1;
+    }
+    return result;
+}
+
+Fingerprint GrammarFingerprint::ofString(const char* s, int len) {
+    Fingerprint f; f.hash = 0; f.length = len;
+    for (int i = 0; i < len; ++i) f.hash = addMod(mulMod(f.hash, BASE), (unsigned char)s[i] + 1);
+    return f;
+}
+
+// fingerprint of the concatenation of strings with fingerprints a and b
+Fingerprint GrammarFingerprint::concat(Fingerprint a, Fingerprint b) {
+    Fingerprint f; 
+    f.hash = addMod(mulMod(a.hash, power(b.length)), b.hash);
+    f.length = a.length + b.length;
+    return f;
+}
+
+// fingerprints of expansions of all the rules, BASE^length of each rule 
+// is kept so that appending a subrule takes constant time
+vector<Fingerprint> GrammarFingerprint::ofRules(CfGrammar* g) {
+    vector<Fingerprint> result(g->getNumRules());
+    vector<unsigned long long> rulePower(g->getNumRules(), 1);
+    vector<int> order = g->bottomUpOrder();
+    for (int i = 0; i < order.size(); ++i) {
+        const CfgRule& rule = g->getRule(order[i]);
+        Fingerprint f; f.hash = 0; f.length = 0;
+        unsigned long long pow = 1;
+        for (int j = 0; j < rule.numFragments(); ++j) {
+            const RuleFragment& frag = rule.getFragment(j);
+            if (frag.isRule) {
+                const Fingerprint& sub = result[frag.ruleIndex];
+                f.hash = addMod(mulMod(f.hash, rulePower[frag.ruleIndex]), sub.hash);
+                f.length += sub.length;
+                pow = mulMod(pow, rulePower[frag.ruleIndex]);
+            }
+            else {
+                for (int k = 0; k < frag.str.size(); ++k) 
+                    f.hash = addMod(mulMod(f.hash, BASE), (unsigned char)frag.str[k] + 1);
+                f.length += frag.str.size();
+                pow = mulMod(pow, power(frag.str.size()));
+            }
+        }
+        result[order[i]] = f;
+        rulePower[order[i]] = pow;
+    }
+    return result;
+}
@@ -0,0 +1,55 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef GRAMMARFINGERPRINT_H
+#define	GRAMMARFINGERPRINT_H
+
+#include <vector>
+
+#include "CfGrammar.h"
+
+using namespace std;
+
+// Karp-Rabin fingerprint and length of a string
+struct Fingerprint {
+    unsigned long long hash;
+    int length;
+    
+    bool operator<(const Fingerprint& f) const {
+        return hash < f.hash || (hash == f.hash && length < f.length);
+    }
+    bool operator==(const Fingerprint& f) const { 
+        return hash == f.hash && length == f.length; 
+    }
+};
+
+/* Karp-Rabin fingerprints modulo the prime 2^61-1. Fingerprint of a 
+ * concatenation is calculated from the fingerprints of the parts, so 
+ * fingerprints of all the rule expansions of a grammar are calculated 
+ * bottom up in time linear in grammar size. */
+class GrammarFingerprint {
+public:
+    static Fingerprint ofString(const char* s, int len);
+    static Fingerprint concat(Fingerprint a, Fingerprint b);
+    static vector<Fingerprint> ofRules(CfGrammar* g);
+    
+    static unsigned long long power(int exp);
+    static unsigned long long mulMod(unsigned long long a, unsigned long long b);
+    static unsigned long long addMod(unsigned long long a, unsigned long long b);
+    
+    static const unsigned long long PRIME;
+    static const unsigned long long BASE;
+    
+};
+
+#endif	/* GRAMMARFINGERPRINT_H */
@@ -0,0 +1,84 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include "GrammarMerger.h"
+
+GrammarMerger::GrammarMerger(): rules(1), numMerged(0) { }
+
+// add all the rules of g except start rule, return map from indexes
+// of the rules of g to the indexes of the merged rules
+vector<int> GrammarMerger::addRules(CfGrammar* g) {
+    vector<Fingerprint> fp = GrammarFingerprint::ofRules(g);
+    vector<int> ruleMap(g->getNumRules(), -1);
+    // subrules are mapped before the rules containing them
+    vector<int> order = g->bottomUpOrder();
+    for (int i = 0; i < order.size(); ++i) {
+        const int r = order[i];
+        if (r == 0) continue;
+        map<Fingerprint, int>::iterator it = index.find(fp[r]);
+        if (it != index.end()) {
+            ruleMap[r] = it->second;
+            numMerged++;
+        }
+        else {
+            ruleMap[r] = rules.size();
+            index[fp[r]] = rules.size();
+            rules.push_back(mapRule(g->getRule(r), ruleMap));
+        }
+    }
+    return ruleMap;
+}
+
+// copy of the rule with rule indexes replaced by merged indexes
+CfgRule GrammarMerger::mapRule(const CfgRule& rule, const vector<int>& ruleMap) {
+    CfgRule result;
+    for (int f = 0; f < rule.numFragments(); ++f) {
+        RuleFragment frag = rule.getFragment(f);
+        if (frag.isRule) frag.ruleIndex = ruleMap[frag.ruleIndex];
+        result.addFragment(frag);
+    }
+    return result;
+}
+
+// append fragments to the start rule, adjacent strings are merged
+void GrammarMerger::append(const CfgRule& fragments) {
+    for (int f = 0; f < fragments.numFragments(); ++f) {
+        const RuleFragment& frag = fragments.getFragment(f);
+        int last = start.numFragments() - 1;
+        if (!frag.isRule && last >= 0 && !start.getFragment(last).isRule) {
+            RuleFragment merged = start.getFragment(last);
+            merged.str += frag.str;
+            merged.refPos = -1;
+            start.setFragment(last, merged);
+        }
+        else start.addFragment(frag);
+    }
+}
+
+// add rules of g and append its start rule to the start rule
+void GrammarMerger::appendGrammar(CfGrammar* g) {
+    vector<int> ruleMap = addRules(g);
+    append(mapRule(g->getRule(0), ruleMap));
+}
+
+// create grammar from merged rules
+CfGrammar* GrammarMerger::createGrammar() {
+    CfGrammar* grammar = new CfGrammar(rules.size());
+    grammar->addRule(0, start);
+    for (int r = 1; r < rules.size(); ++r) grammar->addRule(r, rules[r]);
+    return grammar;
+}
+
+int GrammarMerger::numRules() { return rules.size(); }
+
+int GrammarMerger::getNumMerged() { return numMerged; }
@@ -0,0 +1,52 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef GRAMMARMERGER_H
+#define	GRAMMARMERGER_H
+
+#include <map>
+#include <vector>
+
+#include "CfGrammar.h"
+#include "GrammarFingerprint.h"
+
+using namespace std;
+
+/* Merges rules of many grammars into one rule set, rules with equal expansion 
+ * fingerprints are merged into one rule. Start rule of the merged grammar is 
+ * a concatenation of fragments appended to it, usually start rules of the 
+ * merged grammars with rule indexes mapped to merged rules. */
+class GrammarMerger {
+public:
+    GrammarMerger();
+    
+    vector<int> addRules(CfGrammar* g);
+    CfgRule mapRule(const CfgRule& rule, const vector<int>& ruleMap);
+    void append(const CfgRule& fragments);
+    void appendGrammar(CfGrammar* g);
+    CfGrammar* createGrammar();
+    
+    int numRules();
+    int getNumMerged();
+    
+private:
+    
+    // merged rules, index 0 is reserved for the start rule
+    vector<CfgRule> rules;
+    map<Fingerprint, int> index; // fingerprints of merged rules    
+    CfgRule start;
+    int numMerged; // number of rules merged with an existing rule
+    
+};
+
+#endif	/* GRAMMARMERGER_H */
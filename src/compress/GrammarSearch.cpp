@@ -0,0 +1,143 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <algorithm>
+
+#include "GrammarSearch.h"
+
+GrammarSearch::GrammarSearch(CfGrammar* g): grammar(g), access(g), searched(false) { }
+
+// add pattern to search for, return its index
+int GrammarSearch::addPattern(const string& pattern) {
+    patterns.push_back(pattern);
+    searched = false;
+    return patterns.size() - 1;
+}
+
+// calculate occurrence counts, prefixes and suffixes for all the 
+// patterns, visiting the rules bottom up once
+void GrammarSearch::search() {
+    const int numPatterns = patterns.size(), numRules = grammar->getNumRules();
+    occ.assign(numPatterns, vector<long>(numRules, 0));
+    prefix.assign(numPatterns, vector<string>(numRules));
+    suffix.assign(numPatterns, vector<string>(numRules));
+    vector<int> order = grammar->bottomUpOrder();
+    for (int i = 0; i < order.size(); ++i) {
+        for (int p = 0; p < numPatterns; ++p) {
+            if (patterns[p].empty() == false) searchRule(p, order[i]);
+        }
+    }
+    searched = true;
+}
+
+// number of occurrences of the pattern in the expanded string
+long GrammarSearch::count(int pattern) {
+    if (!searched) search();
+    return occ[pattern][0];
+}
+
+// sorted starting positions of the pattern in the expanded string
+vector<int> GrammarSearch::positions(int pattern) {
+    if (!searched) search();
+    vector<int> result;
+    if (occ[pattern][0] > 0) {
+        result.reserve(occ[pattern][0]);
+        findPositions(pattern, 0, 0, result);
+    }
+    return result;
+}
+
+// calculate search data for a rule, data for all the subrules must be calculated
+void GrammarSearch::searchRule(int p, int rule) {
+    const string& pat = patterns[p];
+    const int m1 = pat.size() - 1; // length of prefixes and suffixes
+    const CfgRule& r = grammar->getRule(rule);
+    // last m-1 chars of the part of the expansion processed so far
+    string window, pre;
+    long count = 0;
+    for (int f = 0; f < r.numFragments(); ++f) {
+        const RuleFragment& frag = r.getFragment(f);
+        if (frag.isRule) {
+            const int sub = frag.ruleIndex;
+            const string& subPrefix = prefix[p][sub];
+            // occurrences crossing the boundary must start in the window
+            string joined = window + subPrefix;
+            count += countMatches(pat, joined, 0, window.size());
+            count += occ[p][sub];            
+            if (pre.size() < m1) pre += subPrefix;
+            if (access.ruleLength(sub) > m1) window = suffix[p][sub];
+            else appendTail(window, subPrefix, m1);            
+        }
+        else {
+            // occurrences ending within the string
+            string joined = window + frag.str;
+            int from = (int)window.size() - m1; if (from < 0) from = 0;
+            count += countMatches(pat, joined, from, joined.size());
+            if (pre.size() < m1) pre += frag.str;
+            appendTail(window, frag.str, m1);
+        }
+    }
+    if (pre.size() > m1) pre.resize(m1);
+    occ[p][rule] = count;
+    prefix[p][rule] = pre;
+    suffix[p][rule] = window;
+}
+
+// add positions of occurrences in the rule's expansion to result, 
+// offset is position of the rule's expansion in the expanded string
+void GrammarSearch::findPositions(int p, int rule, int offset, vector<int>& result) {
+    const string& pat = patterns[p];
+    const int m1 = pat.size() - 1;
+    const CfgRule& r = grammar->getRule(rule);
+    string window;
+    for (int f = 0; f < r.numFragments(); ++f) {
+        const RuleFragment& frag = r.getFragment(f);
+        // position of the fragment in the expanded string
+        const int fpos = offset + access.fragmentStart(rule, f);
+        // window ends at fpos
+        const int wpos = fpos - window.size();
+        if (frag.isRule) {
+            const int sub = frag.ruleIndex;
+            string joined = window + prefix[p][sub];
+            countMatches(pat, joined, 0, window.size(), wpos, &result);
+            if (occ[p][sub] > 0) findPositions(p, sub, fpos, result);
+            if (access.ruleLength(sub) > m1) window = suffix[p][sub];
+            else appendTail(window, prefix[p][sub], m1);
+        }
+        else {
+            string joined = window + frag.str;
+            int from = (int)window.size() - m1; if (from < 0) from = 0;
+            countMatches(pat, joined, from, joined.size(), wpos, &result);
+            appendTail(window, frag.str, m1);
+        }
+    }
+}
+
+// append s to window and keep only last max chars
+void GrammarSearch::appendTail(string& window, const string& s, int max) {
+    window += s;
+    if (window.size() > max) window.erase(0, window.size() - max);
+}
+
+// count occurrences of the pattern in s starting at positions in [from, to), 
+// if pos is not null add their positions, increased by offset, to pos
+long GrammarSearch::countMatches(const string& pattern, const string& s, 
+                                 int from, int to, int offset, vector<int>* pos) {
+    long count = 0;
+    for (size_t i = s.find(pattern, from); i != string::npos && i < to; 
+         i = s.find(pattern, i+1)) {
+        count++;
+        if (pos != 0) pos->push_back(offset + i);
+    }
+    return count;
+}
@@ -0,0 +1,62 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef GRAMMARSEARCH_H
+#define	GRAMMARSEARCH_H
+
+#include <string>
+#include <vector>
+
+#include "CfGrammar.h"
+#include "GrammarAccess.h"
+
+using namespace std;
+
+/* Search for patterns in the string encoded by a grammar, without expansion. 
+ * For each pattern of length m, prefix and suffix of length m-1 of each rule's 
+ * expansion and the number of occurrences within the expansion are calculated 
+ * bottom up, occurrences crossing fragment boundaries are found by matching 
+ * the pattern in the suffix of the preceding part of the rule concatenated with 
+ * the prefix of the following fragment. Time is O(grammar size * m) per pattern,
+ * all the patterns are processed in one pass over the grammar. 
+ * Positions of the occurrences are found by descending into the rules 
+ * that contain occurrences, using offsets from GrammarAccess. */
+class GrammarSearch {
+public:
+    GrammarSearch(CfGrammar* g);
+    
+    int addPattern(const string& pattern);
+    void search();
+    long count(int pattern);
+    vector<int> positions(int pattern);
+    
+private:
+    
+    CfGrammar* grammar;
+    GrammarAccess access;
+    bool searched;
+    
+    vector<string> patterns;
+    // per pattern data, indexed by [pattern][rule]
+    vector<vector<long> > occ; // number of occurrences in rule expansion
+    vector<vector<string> > prefix, suffix; // first and last m-1 chars of expansion
+    
+    void searchRule(int p, int rule);
+    void findPositions(int p, int rule, int offset, vector<int>& result);
+    inline void appendTail(string& window, const string& s, int max);
+    static long countMatches(const string& pattern, const string& s, 
+                             int from, int to, int offset = 0, vector<int>* pos = 0);
+    
+};
+
+#endif	/* GRAMMARSEARCH_H */
@@ -0,0 +1,110 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <cstdlib>
+
+#include "GrammarVerifier.h"
+#include "GrammarAccess.h"
+#include "util/Profiler.h"
+
+const int GrammarVerifier::BLOCK_SIZE = 1 << 16;
+
+// fingerprint of R0 is calculated when the verifier is created
+GrammarVerifier::GrammarVerifier(CfGrammar* g): grammar(g), inputTime(0), spotTime(0), 
+        numChecks(0), mismatches(0) { 
+    ProfileScope scope("verify_fingerprints", &fingerprintTime);
+    expected = GrammarFingerprint::ofRules(grammar)[0];
+    actual.hash = 0; actual.length = 0;
+}
+
+// extend fingerprint of the string with a block of chars
+void GrammarVerifier::addBlock(const char* s, int len) {
+    typedef GrammarFingerprint GF;
+    for (int i = 0; i < len; ++i) 
+        actual.hash = GF::addMod(GF::mulMod(actual.hash, GF::BASE), (unsigned char)s[i] + 1);
+    actual.length += len;
+}
+
+bool GrammarVerifier::compare() { return actual == expected; }
+
+// true if the grammar encodes the string
+bool GrammarVerifier::verify(const char* s, int len) {
+    ProfileScope scope("verify_input", &inputTime);
+    actual.hash = 0; actual.length = 0;
+    addBlock(s, len);
+    return compare();
+}
+
+// true if the grammar encodes the rest of the stream
+bool GrammarVerifier::verify(istream& in) {
+    ProfileScope scope("verify_input", &inputTime);
+    actual.hash = 0; actual.length = 0;
+    vector<char> block(BLOCK_SIZE);
+    while (in) {
+        in.read(&block[0], BLOCK_SIZE);
+        addBlock(&block[0], in.gcount());
+    }
+    return compare();
+}
+
+// compare numChecks substrings of given length at random offsets extracted 
+// from the grammar with the string, return the number of mismatches
+int GrammarVerifier::spotCheck(const char* s, int len, int numChecks, int length, unsigned seed) {
+    ProfileScope scope("verify_spot_checks", &spotTime);
+    GrammarAccess access(grammar);
+    srand(seed);
+    int failed = 0;
+    if (access.length() != len) failed = numChecks;
+    else if (len > 0) {
+        for (int i = 0; i < numChecks; ++i) {
+            int offset = rand() % len;
+            string sub = access.extract(offset, length);
+            if (sub.compare(0, string::npos, s + offset, min(length, len - offset)) != 0) failed++;
+        }
+    }
+    this->numChecks += numChecks; mismatches += failed;
+    return failed;
+}
+
+// spot check against a seekable stream, the substrings are read from 
+// the stream offsets relative to the current position
+int GrammarVerifier::spotCheck(istream& in, int numChecks, int length, unsigned seed) {
+    ProfileScope scope("verify_spot_checks", &spotTime);
+    GrammarAccess access(grammar);
+    const streampos start = in.tellg();
+    in.seekg(0, ios::end);
+    const long len = in.tellg() - start;
+    srand(seed);
+    int failed = 0;
+    if (start < 0 || access.length() != len) failed = numChecks;
+    else if (len > 0) {
+        string expectedSub(length, 0);
+        for (int i = 0; i < numChecks; ++i) {
+            int offset = rand() % len;
+            in.clear(); in.seekg(start + (streamoff)offset);
+            in.read(&expectedSub[0], length);
+            if (access.extract(offset, length) != expectedSub.substr(0, in.gcount())) failed++;
+        }
+    }
+    in.clear(); in.seekg(start);
+    this->numChecks += numChecks; mismatches += failed;
+    return failed;
+}
+
+void GrammarVerifier::printStats(ostream& out) {
+    out << "verify_length: " << actual.length << " grammar_length: " << expected.length;
+    out << " fingerprint_match: " << compare();
+    out << " spot_checks: " << numChecks << " mismatches: " << mismatches;
+    out << " fingerprint_time: " << fingerprintTime << " input_time: " << inputTime;
+    out << " spot_check_time: " << spotTime << endl;
+}
@@ -0,0 +1,57 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef GRAMMARVERIFIER_H
+#define	GRAMMARVERIFIER_H
+
+#include <iostream>
+#include <vector>
+
+#include "CfGrammar.h"
+#include "GrammarFingerprint.h"
+
+using namespace std;
+
+/* Verification of a grammar against the string it encodes, without expansion. 
+ * Fingerprints and lengths of all the rules are calculated bottom up in time 
+ * linear in grammar size, and the fingerprint of R0 is compared with the 
+ * fingerprint of the string, calculated from a stream block by block. 
+ * Different strings have equal fingerprints with probability about length / 2^61. 
+ * Substrings at random offsets can also be extracted by rule descent and 
+ * compared with the string, to check the grammar structure used for access. */
+class GrammarVerifier {
+public:
+    GrammarVerifier(CfGrammar* g);
+    
+    bool verify(const char* s, int len);
+    bool verify(istream& in);
+    int spotCheck(const char* s, int len, int numChecks, int length, unsigned seed = 1);
+    int spotCheck(istream& in, int numChecks, int length, unsigned seed = 1);
+    
+    void printStats(ostream& out);
+    
+private:
+    
+    CfGrammar* grammar;
+    Fingerprint expected, actual;
+    double fingerprintTime, inputTime, spotTime;
+    int numChecks, mismatches;
+    
+    static const int BLOCK_SIZE;
+    
+    void addBlock(const char* s, int len);
+    bool compare();
+    
+};
+
+#endif	/* GRAMMARVERIFIER_H */
@@ -13,43 +13,209 @@
 // under an open source licence. 
 #include "LongestFirstSaCompressor.h"
 #include "radix_sort.h"
-#include "test/etimer.h"
+#include "util/Profiler.h"
+#include "CheckpointFile.h"
+#include "GrammarFingerprint.h"
 
 #include <climits>
 #include <cassert>
 #include <cstring>
+#include <cmath>
 #include <iomanip>
 
-LongestFirstSaCompressor::LongestFirstSaCompressor(const char* s, int l, bool d, bool v): 
-        str(s), N(l), debug(d), verbose(v) { }
+LongestFirstSaCompressor::LongestFirstSaCompressor(const char* s, int l, bool d, bool v,
+        CompressorWorkspace* w): 
+        str(s), N(l), workspace(w), compressionTime(0), timeBudget(0), budgetStart(0), 
+        workBudget(0), partial(false), stopLcp(0), checkpointInterval(0), resume(false), 
+        resumedLcp(0), checkpointErrors(0), useSeparator(false), 
+        targetStart(0), debug(d), verbose(v) { }
     
 LongestFirstSaCompressor::~LongestFirstSaCompressor() {
 }
 
 CfGrammar* LongestFirstSaCompressor::compress() {    
-    startEvent("core_algo");
+    ProfileScope scope("compress");
+    memory.clear();
+    Progress::store(progress.intervalsDone, 0L); 
+    Progress::store(progress.intervalsTotal, 0L); 
+    Progress::store(progress.positionsDone, 0L); 
+    Progress::store(progress.positionsTotal, 0L); 
+    Progress::store(progress.rulesCreated, 0L);
+    partial = false; stopLcp = 0; resumedLcp = 0; checkpointErrors = 0;
+    budgetStart = getWallTime();
+    if (N == 0) { // empty string, grammar with empty R0
+        treeStats.size = 0; treeStats.p = 0;
+        phaseTimes = PhaseTimes();
+        Progress::store(progress.phase, (int)Progress::DONE);
+        CfGrammar* grammar = new CfGrammar(1);
+        grammar->addRule(0, CfgRule());
+        return grammar;
+    }
+    // fail before allocating if the structures known in advance exceed the limit
+    if (memory.getLimit() > 0 && minPeakMemory(N) > memory.getLimit()) return 0;
+    // cpu time of the calling thread, compressors can run in parallel
+    double start = getThreadTime();
+    phaseTimes = PhaseTimes();
+    Progress::store(progress.phase, (int)Progress::SUFFIX_STRUCTURES);
     createSuffixStructures();
     initRuleStructures();   
-    initDescendingLcp();
-    formRules();
+    {
+        ProfileScope phase("schedule", &phaseTimes.schedule);
+        memory.beginPhase("schedule");
+        Progress::store(progress.phase, (int)Progress::SCHEDULE);
+        initDescendingLcp();
+    }
+    {
+        ProfileScope phase("form_rules", &phaseTimes.formRules);
+        memory.beginPhase("form_rules");
+        Progress::store(progress.phase, (int)Progress::FORM_RULES);
+        formRules();
+    }
     deleteSuffixStructures();
-    endEvent("core_algo");
-    CfGrammar* grammar = createGrammar();
+    compressionTime = getThreadTime() - start;
+    CfGrammar* grammar = 0;
+    if (!memory.exceeded()) {
+        ProfileScope phase("create_grammar", &phaseTimes.createGrammar);
+        memory.beginPhase("create_grammar");
+        Progress::store(progress.phase, (int)Progress::CREATE_GRAMMAR);
+        grammar = createGrammar();
+        memory.set(MEM_GRAMMAR, grammar->getMemoryBytes());
+        // the grammar together with the rule structures may exceed the limit
+        if (memory.exceeded()) { delete grammar; grammar = 0; }
+    }
     // free rest of algorithm's allocated memory
+    ProfileScope phase("free");
     freeRuleStructures();
     freeDescendingLcp();    
+    memory.endPhase();
+    Progress::store(progress.phase, (int)Progress::DONE);
     return grammar;
 }
 
+// build the suffix structures and the schedule of the whole string without 
+// forming the rules, measure their time and memory and predict the rest 
+// from the compression of prefixes of sampleSize and sampleSize/2 chars
+LongestFirstSaCompressor::CostEstimate LongestFirstSaCompressor::estimate(int sampleSize) {
+    ProfileScope scope("estimate");
+    CostEstimate e;
+    e.size = N;
+    memory.clear();
+    phaseTimes = PhaseTimes();
+    if (N == 0) return e;
+    createSuffixStructures();
+    initRuleStructures();   
+    {
+        ProfileScope phase("schedule", &phaseTimes.schedule);
+        memory.beginPhase("schedule");
+        initDescendingLcp();
+    }
+    // rule forming allocates the sorted positions in addition
+    memory.set(MEM_SORTED, N * sizeof(int));
+    const long formBytes = memory.getTotal();
+    const long structBytes = memory.getPeak();
+    const long freedBytes = memory.getPeak(MEM_SUFFIX_ARRAY) + memory.getPeak(MEM_LCP_TREE) + N * sizeof(int);
+    e.intervalTreeSize = treeStats.size; 
+    e.treeDepths = treeStats.p;
+    e.maxLcp = maxLcp;
+    e.intervals = Progress::load(progress.intervalsTotal);
+    const long positions = Progress::load(progress.positionsTotal);
+    e.suffixTime = phaseTimes.suffixArray + phaseTimes.inverseSA + phaseTimes.lcpArray + phaseTimes.lcpTree;
+    e.scheduleTime = phaseTimes.schedule;
+    memory.set(MEM_SORTED, 0);
+    deleteSuffixStructures();
+    freeRuleStructures();
+    freeDescendingLcp();
+    memory.endPhase();
+    // calibrate on the prefixes, with the structures of the whole string freed
+    e.sampleSize = min(N, max(sampleSize, 2));
+    long grammarSize[2], repeatBytes = 0, grammarBytes = 0;
+    double positionTime[2], grammarTime = 0;
+    for (int i = 0; i < 2; ++i) {
+        LongestFirstSaCompressor sample(str, e.sampleSize >> i, false, false, workspace);
+        if (useSeparator) sample.setSeparator(separator);
+        CfGrammar* grammar = sample.compress();
+        grammarSize[i] = grammar->getSize();
+        delete grammar;
+        const long samplePositions = Progress::load(sample.progress.positionsTotal);
+        positionTime[i] = samplePositions > 0 ? sample.phaseTimes.formRules / samplePositions : 0;
+        if (i == 0) {
+            grammarTime = sample.phaseTimes.createGrammar;
+            repeatBytes = sample.memory.getPeak(MEM_RULES) + sample.memory.getPeak(MEM_SHORTENED);
+            grammarBytes = sample.memory.getPeak(MEM_GRAMMAR);
+        }
+    }
+    // time per position and grammar size grow as powers of the string length 
+    // (cache misses, compressibility), the exponents are fitted on the two prefixes
+    e.positionTimeExponent = 0;
+    if (positionTime[1] > 0 && positionTime[0] > 0 && e.sampleSize >= 4) {
+        e.positionTimeExponent = log(positionTime[0] / positionTime[1]) / log(2.0);
+        e.positionTimeExponent = min(1.0, max(0.0, e.positionTimeExponent));
+    }
+    const double scale = (double)N / e.sampleSize;
+    e.secondsPerPosition = positionTime[0] * pow(scale, e.positionTimeExponent);
+    e.formRulesTime = e.secondsPerPosition * positions;
+    e.grammarExponent = 1;
+    if (grammarSize[1] > 0 && grammarSize[0] > 0 && e.sampleSize >= 4) {
+        e.grammarExponent = log((double)grammarSize[0] / grammarSize[1]) / log(2.0);
+        e.grammarExponent = min(1.0, max(0.0, e.grammarExponent));
+    }
+    const double growth = pow(scale, e.grammarExponent);
+    e.grammarSize = (long)(grammarSize[0] * growth + 0.5);
+    e.createGrammarTime = grammarTime * growth;
+    // rules and shortened lists are added to the structures of rule forming,
+    // the grammar is created after the suffix array and the tree are freed
+    const long rules = (long)(repeatBytes * growth), grammar = (long)(grammarBytes * growth);
+    e.peakMemory = max(structBytes, max(formBytes + rules, formBytes - freedBytes + rules + grammar));
+    return e;
+}
+
+// print the estimate as key: value pairs on one line
+void LongestFirstSaCompressor::CostEstimate::print(ostream& out) const {
+    out << "string_size: " << size << " interval_tree_size: " << intervalTreeSize 
+        << " sum_of_tree_depths: " << treeDepths 
+        << " alpha: " << (size > 0 ? treeDepths / (double)size : 0) 
+        << " max_lcp: " << maxLcp << " intervals: " << intervals 
+        << " sample_size: " << sampleSize << " seconds_per_position: " << secondsPerPosition 
+        << " position_time_exponent: " << positionTimeExponent 
+        << " grammar_exponent: " << grammarExponent 
+        << " suffix_time: " << suffixTime << " schedule_time: " << scheduleTime 
+        << " form_rules_time: " << formRulesTime << " create_grammar_time: " << createGrammarTime 
+        << " time: " << totalTime() << " peak_memory: " << peakMemory 
+        << " grammar_size: " << grammarSize << endl;
+}
+
 // do actual compression
 void LongestFirstSaCompressor::formRules() {
-    sorted = new int[N]; 
-    for (int l = maxLcp; l >= 2; --l) {
+    // lcp array is no longer needed, its buffer can hold sorted positions
+    sorted = workspace ? workspace->lcp : new int[N]; 
+    memory.set(MEM_SORTED, N * sizeof(int));
+    long intervalsDone = 0, positionsDone = 0;
+    int startLcp = maxLcp;
+    if (resume && readCheckpoint(startLcp, intervalsDone, positionsDone)) resumedLcp = startLcp;
+    double lastCheckpoint = getWallTime();
+    for (int l = startLcp; l >= 2 && !memory.exceeded() && !partial; --l) {
+        Progress::store(progress.lcpLevel, l);
+        // levels without intervals and shortened lists do not change the state
+        if (checkpointPath.empty() == false && l < startLcp && 
+            (numIntervals[l] > 0 || shortPos[l].empty() == false) &&
+            getWallTime() - lastCheckpoint >= checkpointInterval) {
+            writeCheckpoint(l, intervalsDone, positionsDone);
+            lastCheckpoint = getWallTime();
+        }
     // process lcp intervals
         if (numIntervals[l] > 0) {            
+            Profiler::count(INTERVALS_VISITED, numIntervals[l]);
             for (int i = 0; i < numIntervals[l]; ++i) {
+                // out of budget, stop after the shortened lists of this level
+                if (budgetExhausted(positionsDone, intervalsDone)) {
+                    partial = true; stopLcp = l;
+                    break;
+                }
                 int interval = descIntervals[l][i];
                 processInterval(interval);
+                positionsDone += lcpTree.nodes[interval].right - lcpTree.nodes[interval].left + 1;
+                Progress::store(progress.intervalsDone, ++intervalsDone);
+                Progress::store(progress.positionsDone, positionsDone);
                 if (debug) {
                     printStructure();
                     printRules();
@@ -60,6 +226,7 @@ void LongestFirstSaCompressor::formRules() {
         if (shortPos[l].empty() == false) {
             while (shortPos[l].empty() == false) {
                 processShortened(shortPos[l].front(), l);
+                memory.add(MEM_SHORTENED, -shortListBytes(shortPos[l].front()));
                 shortPos[l].pop_front();
                 if (debug) {
                     printStructure();
@@ -68,7 +235,100 @@ void LongestFirstSaCompressor::formRules() {
             }
         }        
     }
-    delete [] sorted;
+    if (workspace == 0) delete [] sorted;
+    memory.set(MEM_SORTED, 0);
+}
+
+// true if the time or work budget is set and used up, time is 
+// checked every 64 intervals to keep the clock out of the loop
+bool LongestFirstSaCompressor::budgetExhausted(long positionsDone, long intervalsDone) {
+    if (workBudget > 0 && positionsDone >= workBudget) return true;
+    if (timeBudget > 0 && (intervalsDone & 63) == 0) return getWallTime() - budgetStart >= timeBudget;
+    return false;
+}
+
+// write rules, substitution table and pending shortened lists before 
+// processing lcp level, all the levels above are done
+void LongestFirstSaCompressor::writeCheckpoint(int level, long intervalsDone, long positionsDone) {
+    ProfileScope scope("checkpoint");
+    unsigned long long inputHash, settings;
+    checkpointHeader(inputHash, settings);
+    CheckpointWriter out(checkpointPath);
+    out.write("CFGK", 4);
+    out.put(CHECKPOINT_VERSION); out.put(N); out.put(inputHash); out.put(settings); 
+    out.put(level); out.put(intervalsDone); out.put(positionsDone); out.put(numRules);
+    out.write(&rules[0], numRules * sizeof(Rule));
+    out.write(subst_table, N * sizeof(int));
+    for (int l = 2; l <= level; ++l) {
+        if (shortPos[l].empty()) continue;
+        out.put(l); out.put((int)shortPos[l].size());
+        list<list<ShortPos> >::iterator it;
+        for (it = shortPos[l].begin(); it != shortPos[l].end(); ++it) {
+            out.put((int)it->size());
+            for (list<ShortPos>::iterator p = it->begin(); p != it->end(); ++p) out.put(*p);
+        }
+    }
+    out.put(0); // end of shortened lists
+    if (!out.commit()) checkpointErrors++;
+}
+
+// restore the state written by writeCheckpoint if the checkpoint is intact and 
+// was written for the same string and settings, return false otherwise, 
+// structures are changed only after the checksum and the header are checked
+bool LongestFirstSaCompressor::readCheckpoint(int& level, long& intervalsDone, long& positionsDone) {
+    ProfileScope scope("resume");
+    if (!CheckpointReader::checkFile(checkpointPath)) return false;
+    CheckpointReader in(checkpointPath);
+    unsigned long long inputHash, hash, settings, s; 
+    int version, n, numR;
+    char magic[4];
+    checkpointHeader(inputHash, settings);
+    if (!in.read(magic, 4) || memcmp(magic, "CFGK", 4) != 0) return false;
+    if (!in.get(version) || version != CHECKPOINT_VERSION || !in.get(n) || n != N) return false;
+    if (!in.get(hash) || hash != inputHash || !in.get(s) || s != settings) return false;
+    if (!in.get(level) || level > maxLcp || level < 2) return false;
+    if (!in.get(intervalsDone) || !in.get(positionsDone) || !in.get(numR)) return false;
+    if (numR < 1 || numR > N + 1) return false;
+    // read into local copies, so a short read leaves the structures unchanged
+    vector<Rule> savedRules(max(numR, 10));
+    vector<int> savedSubst(N);
+    if (!in.read(&savedRules[0], numR * sizeof(Rule))) return false;
+    if (!in.read(&savedSubst[0], N * sizeof(int))) return false;
+    vector<pair<int, list<ShortPos> > > savedLists;
+    int l, numLists, size;
+    while (true) {
+        if (!in.get(l)) return false;
+        if (l == 0) break; // end of shortened lists
+        if (l < 2 || l > level || !in.get(numLists) || numLists < 0) return false;
+        for (int i = 0; i < numLists; ++i) {
+            if (!in.get(size) || size < 0 || size > N) return false;
+            savedLists.push_back(make_pair(l, list<ShortPos>()));
+            ShortPos p;
+            for (int j = 0; j < size; ++j) {
+                if (!in.get(p)) return false;
+                savedLists.back().second.push_back(p);
+            }
+        }
+    }
+    numRules = numR;
+    rules.swap(savedRules);
+    memcpy(subst_table, &savedSubst[0], N * sizeof(int));
+    memory.set(MEM_RULES, rules.capacity() * sizeof(Rule));
+    for (int i = 0; i < savedLists.size(); ++i) {
+        shortPos[savedLists[i].first].push_back(savedLists[i].second);
+        memory.add(MEM_SHORTENED, shortListBytes(savedLists[i].second));
+    }
+    Progress::store(progress.rulesCreated, (long)numRules - 1);
+    Progress::store(progress.intervalsDone, intervalsDone);
+    Progress::store(progress.positionsDone, positionsDone);
+    return true;
+}
+
+// fingerprint of the string and the settings that change the rules, 
+// a checkpoint can only be resumed with the same ones
+void LongestFirstSaCompressor::checkpointHeader(unsigned long long& inputHash, unsigned long long& settings) {
+    inputHash = GrammarFingerprint::ofString(str, N).hash;
+    settings = ((unsigned long long)targetStart << 9) | (useSeparator ? 256 + (unsigned char)separator : 0);
 }
 
 // process lcp interval: traverse the positions and form rule
@@ -85,6 +345,8 @@ void LongestFirstSaCompressor::processInterval(int index) {
     // copy and sort suffix positions in the interval    
     for (int i = 0; i < len; ++i) sorted[i] = suffixArray[node.left + i];
     sortPositions(sorted, len);
+    Profiler::count(POSITIONS_CLASSIFIED, len);
+    if (sorted[len-1] < targetStart) return; // no occurrence in the target
     // traverse the interval positions and form rules
     RulePos first; first.pos = NO_POS;
     // replaceOk is true if new rule can be formed, ie at least two lcp length
@@ -205,9 +467,14 @@ string LongestFirstSaCompressor::getSubstring(int pos, int len) {
 // create new rule of length l starting at position p
 int LongestFirstSaCompressor::createNewRule(RulePos p, int l) {
     int rule = numRules++;
+    Profiler::count(RULES_CREATED);
+    Progress::store(progress.rulesCreated, (long)numRules - 1);
     Substring ss = writeRule(rule, p, l);
     assert(ss.start != NULL_SUBSTRING);
-    if (rules.size() < numRules) rules.resize(rules.size()*2);
+    if (rules.size() < numRules) {
+        rules.resize(rules.size()*2);
+        memory.set(MEM_RULES, rules.capacity() * sizeof(Rule));
+    }
     rules[rule].begin = ss.start;
     rules[rule].end = ss.end;
     rules[rule].prefixRule = NO_PREFIX_RULE;
@@ -330,7 +597,9 @@ LongestFirstSaCompressor::RulePos LongestFirstSaCompressor::findInRulePosition(i
     
     // check if pos is contained in subrules of the rule     
     // expand to the lowes-level subrule
+    int steps = 0;
     while (true) {        
+        steps++;
         const Rule r = rules[rule];                
         // absolute (string) position, this is index of subst_table containing rule info
         int apos = r.begin + pos; 
@@ -382,7 +651,7 @@ LongestFirstSaCompressor::RulePos LongestFirstSaCompressor::findInRulePosition(i
             }
         }                
     }
-    
+    Profiler::count(RULE_POSITION_STEPS, steps);
     return result;
 }
 
@@ -427,6 +696,7 @@ void LongestFirstSaCompressor::processLocalShortened() {
         // longest possible replacement within the list is length of second longest        
         list<ShortPos>::iterator it = l.begin(); it++;   
         shortPos[it->l].push_back(l);
+        memory.add(MEM_SHORTENED, shortListBytes(l));
     }
 }
 
@@ -442,6 +712,11 @@ void LongestFirstSaCompressor::processShortened(const list<ShortPos> &spos, int
     list<RulePos> replaceList; // list of positions where new rule can be form
     if (verbose) { cout << "list with replace length " << len << endl; }
     list<ShortPos>::const_iterator it; 
+    // replace only if some of the positions is in the target
+    bool inTarget = false;
+    for (it = spos.begin(); it != spos.end() && (it->l >= len); ++it) {
+        if (it->pos >= targetStart) inTarget = true;
+    }
     for (it = spos.begin(); it != spos.end() && (it->l >= len); ++it) {
         if (verbose) { 
             cout << "spos: " << it->pos << " slen: " << it->l 
@@ -503,7 +778,7 @@ void LongestFirstSaCompressor::processShortened(const list<ShortPos> &spos, int
         // this segment, shortened from beginning, will be traversed in later lcp interval                
     }
     
-    if (replaceOk) makeReplacements(replaceList, len);        
+    if (replaceOk && inTarget) makeReplacements(replaceList, len);        
         
     // put the rest of the list back to lists to be processed
     if (it == spos.end()) return; // no more positions left
@@ -516,25 +791,61 @@ void LongestFirstSaCompressor::processShortened(const list<ShortPos> &spos, int
         newLen = rest.front().l;
         rest.push_front(firstShort);
         shortPos[newLen].push_back(rest);
+        memory.add(MEM_SHORTENED, shortListBytes(rest));
+        Profiler::count(SHORTENED_REQUEUED);
     }
     else { // only shortened list remains, calculate max. replace length
         if (rest.size() < 2) return; // nothing to replace
         // read length of second longest position (positions are sorted descending by length)
         it = rest.begin(); ++it; newLen = it->l;
         shortPos[newLen].push_back(rest);
+        memory.add(MEM_SHORTENED, shortListBytes(rest));
+        Profiler::count(SHORTENED_REQUEUED);
     }    
 }
 
 // create suffix array and lcp interval tree
 void LongestFirstSaCompressor::createSuffixStructures() {
     ssc = new SuffixStructCreator(str, N);
-    suffixArray = ssc->createSuffixArray();
-    ssc->createInverseSA(); // needed for lcp array creation
-    int * lcpArray = ssc->createLCPArray();
-    ssc->deleteInverseSA();
-    lcpTree = LcpTreeCreator::createLcpTree(lcpArray, N);
+    LcpTreeNode* treeBuffer = 0;
+    if (workspace != 0) {
+        workspace->reserve(N);
+        // aux array is not needed after the suffix array is created
+        ssc->setBuffers(workspace->suffixArray, workspace->aux, workspace->lcp, workspace->aux);
+        treeBuffer = workspace->treeNodes;
+    }
+    if (useSeparator) ssc->setSeparator(separator);
+    {
+        ProfileScope phase("suffix_array", &phaseTimes.suffixArray);
+        memory.beginPhase("suffix_array");
+        // aux array and type bits of sa-is
+        memory.set(MEM_SA_AUX, (N + 1) * sizeof(int) + N / 8 + 1);
+        memory.set(MEM_SUFFIX_ARRAY, (N + 1) * sizeof(int));
+        suffixArray = ssc->createSuffixArray();
+        memory.set(MEM_SA_AUX, 0);
+    }
+    {
+        ProfileScope phase("inverse_sa", &phaseTimes.inverseSA);
+        memory.beginPhase("inverse_sa");
+        memory.set(MEM_INVERSE_SA, N * sizeof(int));
+        ssc->createInverseSA(); // needed for lcp array creation
+    }
+    int * lcpArray;
+    {
+        ProfileScope phase("lcp_array", &phaseTimes.lcpArray);
+        memory.beginPhase("lcp_array");
+        memory.set(MEM_LCP_ARRAY, (N + 1) * sizeof(int));
+        lcpArray = ssc->createLCPArray();
+        ssc->deleteInverseSA();
+        memory.set(MEM_INVERSE_SA, 0);
+    }
+    ProfileScope phase("lcp_tree", &phaseTimes.lcpTree);
+    memory.beginPhase("lcp_tree");
+    memory.set(MEM_LCP_TREE, N * sizeof(LcpTreeNode));
+    lcpTree = LcpTreeCreator::createLcpTree(lcpArray, N, treeBuffer);
     treeStats = LcpTreeCreator::getStats(lcpTree);
     ssc->deleteLCPArray();
+    memory.set(MEM_LCP_ARRAY, 0);
 }
 
 void LongestFirstSaCompressor::printStats(ostream& out) {
@@ -542,14 +853,102 @@ void LongestFirstSaCompressor::printStats(ostream& out) {
     out << " interval_tree_size: " << treeStats.size;
     out << " sum_of_tree_depths: " << treeStats.p;
     double alpha = treeStats.p/(double)N;
-    out << " alpha: " << alpha << endl;        
+    out << " alpha: " << alpha;
+    if (timeBudget > 0 || workBudget > 0) {
+        out << " partial: " << partial << " stopped_at_lcp: " << stopLcp 
+            << " intervals_done: " << Progress::load(progress.intervalsDone) 
+            << " of " << Progress::load(progress.intervalsTotal) 
+            << " positions_done: " << Progress::load(progress.positionsDone) 
+            << " of " << Progress::load(progress.positionsTotal);
+    }
+    out << endl;        
+}
+
+// stop rule forming after the wall time in seconds since the start of 
+// compression, or after the number of interval positions (sum of tree 
+// depths is the total), 0 is no budget
+void LongestFirstSaCompressor::setTimeBudget(double seconds) { timeBudget = seconds; }
+
+void LongestFirstSaCompressor::setWorkBudget(long positions) { workBudget = positions; }
+
+// true if the last compression was stopped by the budget, the grammar 
+// holds the rules formed until then
+bool LongestFirstSaCompressor::isPartial() { return partial; }
+
+// write checkpoints of rule forming to path every interval seconds (at lcp 
+// level boundaries), if resume is true continue from the checkpoint in path 
+// if it is intact and matches the string, the grammar is the same as without 
+// the interruption
+void LongestFirstSaCompressor::setCheckpoint(const string& path, double interval, bool r) {
+    checkpointPath = path; checkpointInterval = interval; resume = r;
+}
+
+// lcp level from which the last compression continued, 0 if it was not resumed
+int LongestFirstSaCompressor::getResumedLcp() { return resumedLcp; }
+
+// number of checkpoints that could not be written in the last compression
+int LongestFirstSaCompressor::getCheckpointErrors() { return checkpointErrors; }
+
+const int LongestFirstSaCompressor::CHECKPOINT_VERSION = 1;
+
+// separate the string into parts that can not share a rule, separator 
+// char will be left unreplaced and no rule will span two parts
+void LongestFirstSaCompressor::setSeparator(char sep) {
+    useSeparator = true;
+    separator = sep;
+}
+
+// form rules only for the substrings with an occurrence at or after pos, 
+// the string before pos is used only as a source of repeats
+void LongestFirstSaCompressor::setTargetStart(int pos) {
+    targetStart = pos;
+}
+
+// cpu time of the last compression, in seconds
+double LongestFirstSaCompressor::getCompressionTime() { return compressionTime; }
+
+const LongestFirstSaCompressor::PhaseTimes& LongestFirstSaCompressor::getPhaseTimes() { 
+    return phaseTimes; 
+}
+
+// size and sum of depths of the lcp interval tree of the last compression
+const LcpTreeStats& LongestFirstSaCompressor::getTreeStats() { return treeStats; }
+
+const char* const LongestFirstSaCompressor::Progress::PHASE_NAMES[] = { 
+    "not_started", "suffix_structures", "schedule", "form_rules", "create_grammar", "done" 
+};
+
+const LongestFirstSaCompressor::Progress& LongestFirstSaCompressor::getProgress() { return progress; }
+
+// bytes used by the structures in the last compression, limit can be set before compression
+MemoryUsage& LongestFirstSaCompressor::getMemoryUsage() { return memory; }
+
+// lower bound of the peak bytes accounted in compression: the structures 
+// whose size depends only on the string length, the structures that depend
+// on the repeats (rules, shortened lists, intervals) are not included
+long LongestFirstSaCompressor::minPeakMemory(int N) {
+    const long n = N, I = sizeof(int);
+    long peak = (n + 1) * I * 2 + n / 8 + 1; // suffix array with aux
+    peak = max(peak, (n + 1) * I + n * I + (n + 1) * I); // with inverse sa and lcp
+    peak = max(peak, (n + 1) * I * 2 + n * (long)sizeof(LcpTreeNode)); // lcp tree from lcp
+    // rule forming: suffix array, tree, substitution table, sorted positions
+    peak = max(peak, (n + 1) * I + n * (long)sizeof(LcpTreeNode) + 2 * n * I);
+    return peak;
+}
+
+// bytes of the nodes of a shortened positions list in the global lists
+long LongestFirstSaCompressor::shortListBytes(const list<ShortPos>& l) {
+    const long nodeLinks = 2 * sizeof(void*);
+    return sizeof(list<ShortPos>) + nodeLinks + l.size() * (sizeof(ShortPos) + nodeLinks);
 }
 
 // delete suffix array and suffix struct creator
 void LongestFirstSaCompressor::deleteSuffixStructures() {
     ssc->deleteSuffixArray();
     delete ssc;
-    lcpTree.freeMemory();
+    if (workspace == 0) lcpTree.freeMemory();
+    memory.set(MEM_SUFFIX_ARRAY, 0);
+    memory.set(MEM_LCP_TREE, 0);
 }
 
 // traverse lcp interval tree and store intervals in descending order
@@ -584,6 +983,16 @@ void LongestFirstSaCompressor::initDescendingLcp() {
     // short positions bookkeeping
     shortPos = new list<list<ShortPos> > [maxLcp+1];
     localShortPos = new list<int> [maxLcp+1];
+    const long perLcp = sizeof(int*) + sizeof(int) + sizeof(list<list<ShortPos> >) + sizeof(list<int>);
+    long intervals = 0, positions = 0;
+    for (int i = 2; i <= maxLcp; ++i) intervals += numIntervals[i];
+    for (int i = 0; i < lcpTree.size; ++i) {
+        if (lcpTree.nodes[i].lcp > 1) positions += lcpTree.nodes[i].right - lcpTree.nodes[i].left + 1;
+    }
+    memory.set(MEM_DESC_INTERVALS, (maxLcp + 1) * perLcp + intervals * sizeof(int));
+    Progress::store(progress.maxLcp, maxLcp);
+    Progress::store(progress.intervalsTotal, intervals);
+    Progress::store(progress.positionsTotal, positions);
 }
 
 // free descIntervals data
@@ -595,6 +1004,8 @@ void LongestFirstSaCompressor::freeDescendingLcp() {
     delete [] numIntervals;
     delete [] shortPos;
     delete [] localShortPos;
+    memory.set(MEM_DESC_INTERVALS, 0);
+    memory.set(MEM_SHORTENED, 0);
 }
 
 const int LongestFirstSaCompressor::UNREPLACED = INT_MAX;
@@ -602,18 +1013,22 @@ const int LongestFirstSaCompressor::NO_PREFIX_RULE = INT_MIN;
 
 // allocate and initialize structures for rule related structures
 void LongestFirstSaCompressor::initRuleStructures() {
-    subst_table = new int[N];    
+    // inverse suffix array is deleted, its buffer can hold the table
+    subst_table = workspace ? workspace->aux : new int[N];    
     for (int i = 0; i < N; ++i) {
         subst_table[i] = UNREPLACED;        
     }        
     numRules = 1; // index zero is reserved for the "entire string rule"
     rules.resize(10);
+    memory.set(MEM_SUBST_TABLE, N * sizeof(int));
+    memory.set(MEM_RULES, rules.capacity() * sizeof(Rule));
 }
 
 // free memory of rule related structures
 void LongestFirstSaCompressor::freeRuleStructures() {
-    delete [] subst_table;    
+    if (workspace == 0) delete [] subst_table;    
     rules.clear();
+    memory.set(MEM_SUBST_TABLE, 0);
 }
     
 // create (explicit) context free grammar from internal representation
@@ -635,11 +1050,8 @@ CfgRule LongestFirstSaCompressor::stringToCfgRule() {
         if (subst_table[i] == UNREPLACED) { // create fragment containing a string
             // get length of unreplaced part
             for (l = 1; i+l < N && subst_table[i+l] == UNREPLACED; ++l);
-            char substr[l+1];
-            for (int j = 0; j < l; ++j) substr[j] = str[i+j];
-            substr[l] = 0;
             frag.isRule = false;
-            frag.str = substr;            
+            frag.str.assign(str + i, l); // string can contain zero chars
         }
         else { // create fragment containing a rule
             assert(subst_table[i] > 0); // must be a start of the rule
@@ -675,11 +1087,8 @@ CfgRule LongestFirstSaCompressor::ruleToCfgRule(int rule) {
         if (i==b || subst_table[i] <= 0 && -subst_table[i] == b) { // not a subrule
             // get length of the non subrule part
             for (l = 1; i+l <= e && subst_table[i+l] <= 0 && -subst_table[i+l] == b; ++l);
-            char substr[l+1];
-            for (int j = 0; j < l; ++j) substr[j] = str[i+j];
-            substr[l] = 0;
             frag.isRule = false;    
-            frag.str = substr;            
+            frag.str.assign(str + i, l);
         }
         else { // create fragment containing a subrule
             assert(subst_table[i] > 0); // must be a start of the subrule
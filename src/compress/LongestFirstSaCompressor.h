@@ -22,23 +22,126 @@
 #include "suffix/SuffixStructCreator.h"
 #include "CfGrammar.h"
 #include "FastSort.h"
+#include "CompressorWorkspace.h"
+#include "MemoryUsage.h"
 
 using namespace std;
 
 class LongestFirstSaCompressor {
     
 public:
-    LongestFirstSaCompressor(const char* s, int l, bool d = false, bool v = false);
+    LongestFirstSaCompressor(const char* s, int l, bool d = false, bool v = false, 
+                             CompressorWorkspace* w = 0);
     virtual ~LongestFirstSaCompressor();
     
+    // wall times of the phases of the last compression, in seconds
+    struct PhaseTimes {
+        PhaseTimes(): suffixArray(0), inverseSA(0), lcpArray(0), lcpTree(0), 
+                      schedule(0), formRules(0), createGrammar(0) {}
+        double suffixArray, inverseSA, lcpArray, lcpTree, schedule, formRules, createGrammar;
+    };
+    
+    // progress of the running compression, written by the compressing thread 
+    // with relaxed atomic stores so that a monitor thread can sample it
+    struct Progress {
+        enum Phase { NOT_STARTED, SUFFIX_STRUCTURES, SCHEDULE, FORM_RULES, CREATE_GRAMMAR, DONE };
+        Progress(): phase(NOT_STARTED), lcpLevel(0), maxLcp(0), intervalsDone(0), 
+                    intervalsTotal(0), positionsDone(0), positionsTotal(0), rulesCreated(0) {}
+        int phase, lcpLevel, maxLcp;
+        long intervalsDone, intervalsTotal;
+        // positions of the intervals, measure of the work of rule forming
+        long positionsDone, positionsTotal;
+        long rulesCreated;
+        template <typename T> static inline void store(T& field, T value) { 
+            __atomic_store_n(&field, value, __ATOMIC_RELAXED); 
+        }
+        template <typename T> static inline T load(const T& field) { 
+            return __atomic_load_n(&field, __ATOMIC_RELAXED); 
+        }
+        static const char* const PHASE_NAMES[];
+    };
+    
+    // cost of compression predicted from the suffix structures of the whole 
+    // string, with rule forming time per interval position and grammar growth 
+    // calibrated by compressing two prefixes of the string
+    struct CostEstimate {
+        CostEstimate(): size(0), intervalTreeSize(0), treeDepths(0), maxLcp(0), intervals(0), 
+                        sampleSize(0), suffixTime(0), scheduleTime(0), formRulesTime(0), 
+                        createGrammarTime(0), secondsPerPosition(0), positionTimeExponent(0), 
+                        grammarExponent(0), 
+                        peakMemory(0), grammarSize(0) {}
+        int size, intervalTreeSize;
+        long treeDepths;
+        int maxLcp;
+        long intervals;
+        int sampleSize;
+        double suffixTime, scheduleTime, formRulesTime, createGrammarTime;
+        double secondsPerPosition, positionTimeExponent, grammarExponent;
+        long peakMemory, grammarSize;
+        double totalTime() const { return suffixTime + scheduleTime + formRulesTime + createGrammarTime; }
+        void print(ostream& out) const;
+    };
+    
     CfGrammar* compress();
+    CostEstimate estimate(int sampleSize);
     void printStats(ostream& out);
+    double getCompressionTime();
+    const PhaseTimes& getPhaseTimes();
+    const LcpTreeStats& getTreeStats();
+    MemoryUsage& getMemoryUsage();
+    const Progress& getProgress();
+    
+    static long minPeakMemory(int N);
+    void setTimeBudget(double seconds);
+    void setWorkBudget(long positions);
+    bool isPartial();
+    void setCheckpoint(const string& path, double interval, bool resume);
+    int getResumedLcp();
+    int getCheckpointErrors();
+    void setSeparator(char sep);
+    void setTargetStart(int pos);
         
 private:
 
     const char * str;
     int N;
     
+    // if not null, buffers are taken from the workspace instead of allocated
+    CompressorWorkspace* workspace;
+    double compressionTime;
+    PhaseTimes phaseTimes;
+    // bytes used by the structures, compress() returns 0 if the limit is exceeded
+    MemoryUsage memory;
+    Progress progress;
+    
+    // if > 0, rule forming stops when the wall time since the start of 
+    // compression or the interval positions processed exceed the budget, 
+    // rules formed until then are kept and the grammar is still valid
+    double timeBudget, budgetStart;
+    long workBudget;
+    bool partial; // true if the last compression was stopped by the budget
+    int stopLcp; // lcp level at which rule forming stopped
+    inline bool budgetExhausted(long positionsDone, long intervalsDone);
+    
+    // state of rule forming is written to checkpointPath at the start of an lcp 
+    // level if checkpointInterval seconds passed since the last checkpoint, 
+    // with resume compression continues from the level of the checkpoint
+    string checkpointPath;
+    double checkpointInterval;
+    bool resume;
+    int resumedLcp, checkpointErrors;
+    static const int CHECKPOINT_VERSION;
+    void writeCheckpoint(int level, long intervalsDone, long positionsDone);
+    bool readCheckpoint(int& level, long& intervalsDone, long& positionsDone);
+    void checkpointHeader(unsigned long long& inputHash, unsigned long long& settings);
+    
+    // if true, no rule will contain the separator char
+    bool useSeparator;
+    char separator;
+    
+    // rules are formed only for substrings occurring at or after targetStart
+    int targetStart;
+    
     SuffixStructCreator* ssc;
     int *suffixArray;
     LcpTree lcpTree;
@@ -88,6 +191,7 @@ private:
     };
 
     static const int NO_LOCAL_SHORT;
+    static long shortListBytes(const list<ShortPos>& l);
     
     list<int>* localShortPos; // short position within an interval
     // global lists of,  list of short positions each list holds short
@@ -0,0 +1,103 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+
+#include "MemoryUsage.h"
+
+const char* const MemoryUsage::STRUCTURE_NAMES[] = {
+    "suffix_array", "sa_aux", "inverse_sa", "lcp_array", "lcp_tree", "desc_intervals", 
+    "subst_table", "sorted_positions", "rules", "shortened_lists", "grammar"
+};
+
+MemoryUsage::MemoryUsage(): limit(0), trackResident(false) { clear(); }
+
+void MemoryUsage::clear() {
+    for (int s = 0; s < NUM_MEMORY_STRUCTURES; ++s) current[s] = peak[s] = 0;
+    total = totalPeak = 0;
+    phases.clear();
+    inPhase = false;
+}
+
+// set bytes currently used by a structure
+void MemoryUsage::set(MemoryStructure s, long bytes) {
+    add(s, bytes - current[s]);
+}
+
+// add bytes to a structure, negative to release
+void MemoryUsage::add(MemoryStructure s, long bytes) {
+    current[s] += bytes;
+    total += bytes;
+    if (current[s] > peak[s]) peak[s] = current[s];
+    if (total > totalPeak) totalPeak = total;
+    if (inPhase && total > phases.back().peak) phases.back().peak = total;
+}
+
+// end the current phase and start a new one
+void MemoryUsage::beginPhase(const char* name) {
+    endPhase();
+    Phase p; p.name = name; p.peak = total; p.residentPeak = 0;
+    phases.push_back(p);
+    inPhase = true;
+}
+
+void MemoryUsage::endPhase() {
+    if (!inPhase) return;
+    if (trackResident) phases.back().residentPeak = peakResidentBytes();
+    inPhase = false;
+}
+
+// limit for the sum of the structures, 0 for no limit
+void MemoryUsage::setLimit(long bytes) { limit = bytes; }
+
+void MemoryUsage::setResidentTracking(bool on) { trackResident = on; }
+
+bool MemoryUsage::exceeded() const { return limit > 0 && totalPeak > limit; }
+
+long MemoryUsage::getLimit() const { return limit; }
+
+long MemoryUsage::getPeak() const { return totalPeak; }
+
+long MemoryUsage::getPeak(MemoryStructure s) const { return peak[s]; }
+
+// bytes currently used by all the structures
+long MemoryUsage::getTotal() const { return total; }
+
+void MemoryUsage::printStats(ostream& out, int inputSize) {
+    const double perChar = inputSize > 0 ? (double)totalPeak / inputSize : 0;
+    out << "memory_peak: " << totalPeak << " bytes_per_char: " << setprecision(4) << perChar
+        << " resident_peak: " << peakResidentBytes() << endl;
+    for (int s = 0; s < NUM_MEMORY_STRUCTURES; ++s) {
+        out << (s > 0 ? " " : "") << STRUCTURE_NAMES[s] << ": " << peak[s];
+    }
+    out << endl;
+    for (int p = 0; p < phases.size(); ++p) {
+        out << "phase: " << phases[p].name << " memory_peak: " << phases[p].peak 
+            << " resident_peak: " << phases[p].residentPeak << endl;
+    }
+}
+
+// peak resident set size of the process in bytes, 0 if unknown
+long MemoryUsage::peakResidentBytes() {
+    FILE* f = fopen("/proc/self/status", "r");
+    if (f == 0) return 0;
+    char line[256];
+    long kb = 0;
+    while (fgets(line, sizeof(line), f) != 0) {
+        if (strncmp(line, "VmHWM:", 6) == 0) { sscanf(line + 6, "%ld", &kb); break; }
+    }
+    fclose(f);
+    return kb * 1024;
+}
@@ -0,0 +1,71 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef MEMORYUSAGE_H
+#define	MEMORYUSAGE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+enum MemoryStructure {
+    MEM_SUFFIX_ARRAY, MEM_SA_AUX, MEM_INVERSE_SA, MEM_LCP_ARRAY, MEM_LCP_TREE, 
+    MEM_DESC_INTERVALS, MEM_SUBST_TABLE, MEM_SORTED, MEM_RULES, MEM_SHORTENED, 
+    MEM_GRAMMAR, NUM_MEMORY_STRUCTURES
+};
+
+/* Bytes used by the data structures of one compression, as reported by 
+ * the compressor when it allocates, resizes and frees them. Peak of each 
+ * structure and of the sum is kept, and for each phase the peak of the sum 
+ * within the phase, and if resident tracking is on, peak resident size of 
+ * the process at the end of the phase (read from /proc). If a limit is set, 
+ * exceeded() becomes true when the sum grows above it. */
+class MemoryUsage {
+public:
+    MemoryUsage();
+    
+    void set(MemoryStructure s, long bytes);
+    void add(MemoryStructure s, long bytes);
+    void beginPhase(const char* name);
+    void endPhase();
+    void clear();
+    
+    void setLimit(long bytes);
+    void setResidentTracking(bool on);
+    bool exceeded() const;
+    long getLimit() const;
+    long getPeak() const;
+    long getTotal() const;
+    long getPeak(MemoryStructure s) const;
+    void printStats(ostream& out, int inputSize);
+    
+    static long peakResidentBytes();
+    
+    static const char* const STRUCTURE_NAMES[];
+    
+private:
+    long current[NUM_MEMORY_STRUCTURES], peak[NUM_MEMORY_STRUCTURES];
+    long total, totalPeak, limit;
+    
+    struct Phase {
+        string name;
+        long peak, residentPeak;
+    };
+    vector<Phase> phases;
+    bool inPhase, trackResident;
+    
+};
+
+#endif	/* MEMORYUSAGE_H */
@@ -0,0 +1,123 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include "RuleInliner.h"
+
+RuleInliner::RuleInliner(int t): threshold(t), rulesBefore(0), rulesAfter(0),
+        sizeBefore(0), sizeAfter(0), visitsBefore(0), visitsAfter(0) { }
+
+// create new grammar with unprofitable rules inlined, 
+// it expands to the same string as the original grammar
+CfGrammar* RuleInliner::inlineRules(CfGrammar* g) {
+    const int numRules = g->getNumRules();
+    // count uses of the rules
+    vector<int> uses(numRules, 0);
+    for (int r = 0; r < numRules; ++r) {
+        const CfgRule& rule = g->getRule(r);
+        for (int f = 0; f < rule.numFragments(); ++f) {
+            const RuleFragment& frag = rule.getFragment(f);
+            if (frag.isRule) uses[frag.ruleIndex]++;
+        }
+    }
+    // calculate sizes of the rules with inlined subrules and decide what to inline
+    vector<int> size(numRules, 0);
+    vector<bool> inlined(numRules, false);
+    vector<int> order = g->bottomUpOrder();
+    for (int i = 0; i < order.size(); ++i) {
+        int r = order[i];
+        const CfgRule& rule = g->getRule(r);
+        for (int f = 0; f < rule.numFragments(); ++f) {
+            const RuleFragment& frag = rule.getFragment(f);
+            if (frag.isRule) size[r] += inlined[frag.ruleIndex] ? size[frag.ruleIndex] : 1;
+            else size[r] += frag.str.size();
+        }
+        long saving = (long)(uses[r]-1)*(size[r]-1) - 1;
+        if (r != 0 && saving < threshold) inlined[r] = true;
+    }
+    // renumber remaining rules
+    vector<int> newIndex(numRules, -1);
+    int numNew = 0;
+    for (int r = 0; r < numRules; ++r) if (!inlined[r]) newIndex[r] = numNew++;
+    CfGrammar* result = new CfGrammar(numNew);
+    for (int r = 0; r < numRules; ++r) {
+        if (inlined[r]) continue;
+        CfgRule rule;
+        appendInlined(g, r, inlined, newIndex, rule);
+        result->addRule(newIndex[r], rule);
+    }
+    
+    rulesBefore = numRules; rulesAfter = numNew;
+    sizeBefore = g->getSize(); sizeAfter = result->getSize();
+    visitsBefore = decodeVisits(g); visitsAfter = decodeVisits(result);
+    return result;
+}
+
+// append right side of the rule to result, replacing inlined 
+// subrules with their right sides and merging adjacent strings
+void RuleInliner::appendInlined(CfGrammar* g, int rule, const vector<bool>& inlined, 
+                                const vector<int>& newIndex, CfgRule& result) {
+    // stack of (rule, next fragment) pairs, chains of inlined rules can be long
+    vector<pair<int, int> > stack;
+    stack.push_back(make_pair(rule, 0));
+    string str; // pending string fragment
+    while (stack.empty() == false) {
+        pair<int, int>& top = stack.back();
+        const CfgRule& r = g->getRule(top.first);
+        if (top.second == r.numFragments()) { stack.pop_back(); continue; }
+        const RuleFragment& frag = r.getFragment(top.second++);
+        if (frag.isRule == false) str += frag.str;
+        else if (inlined[frag.ruleIndex]) stack.push_back(make_pair(frag.ruleIndex, 0));
+        else {
+            if (str.empty() == false) {
+                RuleFragment s; s.isRule = false; s.str = str;
+                result.addFragment(s);
+                str.clear();
+            }
+            RuleFragment sub; sub.isRule = true; sub.ruleIndex = newIndex[frag.ruleIndex];
+            result.addFragment(sub);
+        }
+    }
+    if (str.empty() == false) {
+        RuleFragment s; s.isRule = false; s.str = str;
+        result.addFragment(s);
+    }
+}
+
+// number of rule expansions performed when expanding the whole grammar, 
+// the number of indirections a decoder has to follow
+long RuleInliner::decodeVisits(CfGrammar* g) {
+    const int numRules = g->getNumRules();
+    vector<long> visits(numRules, 0);
+    visits[0] = 1;
+    // top down order, every rule is visited after all the rules using it
+    vector<int> order = g->bottomUpOrder();
+    long total = 0;
+    for (int i = order.size()-1; i >= 0; --i) {
+        int r = order[i];
+        total += visits[r];
+        const CfgRule& rule = g->getRule(r);
+        for (int f = 0; f < rule.numFragments(); ++f) {
+            const RuleFragment& frag = rule.getFragment(f);
+            if (frag.isRule) visits[frag.ruleIndex] += visits[r];
+        }
+    }
+    return total;
+}
+
+void RuleInliner::printStats(ostream& out) {
+    out << "inline_threshold: " << threshold;
+    out << " rules_before_inline: " << rulesBefore << " rules_after_inline: " << rulesAfter;
+    out << " size_before_inline: " << sizeBefore << " size_after_inline: " << sizeAfter;
+    out << " decode_visits_before_inline: " << visitsBefore;
+    out << " decode_visits_after_inline: " << visitsAfter << endl;
+}
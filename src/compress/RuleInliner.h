@@ -0,0 +1,53 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef RULEINLINER_H
+#define	RULEINLINER_H
+
+#include <iostream>
+#include <vector>
+
+#include "CfGrammar.h"
+
+using namespace std;
+
+/* Post-pass over a grammar that inlines rules that do not pay off, ie rules
+ * used only once or with short right sides. For a rule of size s (terminals 
+ * plus non-terminals on the right side) used u times, keeping the rule saves 
+ * (u-1)*(s-1)-1 symbols, rules with saving below the threshold are replaced 
+ * by their right sides. Rules are decided bottom up so the sizes of the rules 
+ * include inlined subrules, uses are counted in the original grammar. 
+ * Remaining rules are renumbered keeping their relative order. */
+class RuleInliner {
+public:
+    RuleInliner(int threshold = 1);
+    
+    CfGrammar* inlineRules(CfGrammar* g);
+    void printStats(ostream& out);
+    
+    static long decodeVisits(CfGrammar* g);
+    
+private:
+    
+    int threshold;
+    
+    // statistics of the last inlining
+    int rulesBefore, rulesAfter, sizeBefore, sizeAfter;
+    long visitsBefore, visitsAfter;
+    
+    void appendInlined(CfGrammar* g, int rule, const vector<bool>& inlined, 
+                       const vector<int>& newIndex, CfgRule& result);
+    
+};
+
+#endif	/* RULEINLINER_H */
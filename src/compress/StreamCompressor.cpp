@@ -0,0 +1,300 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+#include "StreamCompressor.h"
+#include "LongestFirstSaCompressor.h"
+#include "util/Profiler.h"
+
+static const char STREAM_MAGIC[4] = {'C', 'F', 'G', 'S'};
+
+const int StreamCompressor::SEED_LENGTH = 16;
+
+static void writeInt(ostream& out, int i) { out.write((const char *)&i, sizeof(int)); }
+
+static bool readInt(istream& in, int& i) { 
+    in.read((char *)&i, sizeof(int)); 
+    return in.good();
+}
+
+StreamCompressor::StreamCompressor(int window, int ovl, int maxR): 
+        windowSize(window), overlap(ovl), maxRules(maxR), nextRule(1), 
+        anchorPower(GrammarFingerprint::power(SEED_LENGTH)), 
+        numWindows(0), numEmitted(0), numReused(0), numClears(0), numSeeded(0), 
+        inputSize(0), outputSize(0), compressionTime(0) {
+    if (windowSize < 1) windowSize = 1;
+    if (overlap < 0) overlap = 0;
+    if (maxRules < 1) maxRules = 1;
+}
+
+StreamCompressor::~StreamCompressor() { }
+
+// read the input block by block and write compressed records to out
+void StreamCompressor::compress(istream& in, ostream& out) {
+    double start = getWallTime();
+    out.write(STREAM_MAGIC, sizeof(STREAM_MAGIC));
+    string text; // context followed by the current block
+    int contextLen = 0;
+    vector<char> block(windowSize);
+    while (true) {
+        in.read(&block[0], windowSize);
+        int n = in.gcount();
+        if (n == 0) break;
+        text.append(&block[0], n);
+        inputSize += n;
+        compressWindow(text, contextLen, out);
+        // last overlap chars are the context of the next window
+        contextLen = min(overlap, (int)text.size());
+        text.erase(0, text.size() - contextLen);
+    }
+    out.flush();
+    compressionTime = getWallTime() - start;
+}
+
+void StreamCompressor::compressWindow(const string& text, int contextLen, ostream& out) {
+    numWindows++;
+    LongestFirstSaCompressor comp(text.data(), text.size(), false, false, &workspace);
+    CfGrammar* g = comp.compress();
+    vector<Fingerprint> fp = GrammarFingerprint::ofRules(g);
+    // clear the table before the window so the window does not 
+    // reference rules that are forgotten by the decompressor
+    if ((int)ruleTable.size() + g->getNumRules() > maxRules && ruleTable.empty() == false) {
+        ruleTable.clear();
+        anchors.clear();
+        out.put('C'); outputSize++;
+        numClears++;
+    }
+    GrammarAccess access(g);
+    CfgRule start, encoded;
+    appendSuffix(g, access, 0, contextLen, start);
+    vector<int> global(g->getNumRules(), -1);
+    encodeStart(g, fp, global, start, text.data() + contextLen, encoded, out);
+    writeRecord(out, 'S', 0, encoded);
+    delete g;
+}
+
+// append to out the fragments encoding suffix of the rule from the offset on
+void StreamCompressor::appendSuffix(CfGrammar* g, GrammarAccess& access, int rule, 
+                                    int offset, CfgRule& out) {
+    const CfgRule& r = g->getRule(rule);
+    int f = access.findFragment(rule, offset);
+    int fragOffset = offset - access.fragmentStart(rule, f);
+    const RuleFragment& frag = r.getFragment(f);
+    if (fragOffset == 0) out.addFragment(frag);
+    else if (frag.isRule) appendSuffix(g, access, frag.ruleIndex, fragOffset, out);
+    else {
+        RuleFragment suffix = frag;
+        suffix.str.erase(0, fragOffset);
+        if (suffix.refPos >= 0) suffix.refPos += fragOffset;
+        out.addFragment(suffix);
+    }
+    for (int i = f + 1; i < r.numFragments(); ++i) out.addFragment(r.getFragment(i));
+}
+
+// append to out at most len first chars of the expansion of the rule
+static void expandPrefix(CfGrammar* g, int rule, int len, string& out) {
+    const CfgRule& r = g->getRule(rule);
+    for (int i = 0; i < r.numFragments() && (int)out.size() < len; ++i) {
+        const RuleFragment& frag = r.getFragment(i);
+        if (frag.isRule) expandPrefix(g, frag.ruleIndex, len, out);
+        else out.append(frag.str, 0, min(frag.str.size(), len - out.size()));
+    }
+}
+
+// return global index of a rule of the window grammar, 
+// rules not in the table are written to out, children first
+int StreamCompressor::mapRule(CfGrammar* g, const vector<Fingerprint>& fp, 
+                              vector<int>& global, int rule, ostream& out) {
+    if (global[rule] != -1) return global[rule];
+    map<Fingerprint, int>::iterator it = ruleTable.find(fp[rule]);
+    if (it != ruleTable.end()) {
+        numReused++;
+        return global[rule] = it->second;
+    }
+    CfgRule body = g->getRule(rule);
+    for (int i = 0; i < body.numFragments(); ++i) {
+        RuleFragment frag = body.getFragment(i);
+        if (frag.isRule == false) continue;
+        frag.ruleIndex = mapRule(g, fp, global, frag.ruleIndex, out);
+        body.setFragment(i, frag);
+    }
+    int index = nextRule++;
+    ruleTable[fp[rule]] = index;
+    if (fp[rule].length >= SEED_LENGTH) {
+        string prefix;
+        expandPrefix(g, rule, SEED_LENGTH, prefix);
+        Fingerprint anchor = GrammarFingerprint::ofString(prefix.data(), prefix.size());
+        anchors.insert(make_pair(anchor.hash, make_pair(fp[rule], index)));
+    }
+    writeRecord(out, 'R', index, body);
+    numEmitted++;
+    return global[rule] = index;
+}
+
+// fragment holding len chars of the string fragment from the offset on
+static RuleFragment subFragment(const RuleFragment& frag, int offset, int len) {
+    RuleFragment sub = frag;
+    sub.str = frag.str.substr(offset, len);
+    if (frag.refPos >= 0) sub.refPos = frag.refPos + offset;
+    return sub;
+}
+
+// fingerprint hash of the substring of length len at pos, from prefix hashes
+static unsigned long long substringHash(const vector<unsigned long long>& h, int pos, int len, 
+                                        unsigned long long basePower) {
+    unsigned long long prefix = GrammarFingerprint::mulMod(h[pos], basePower);
+    return GrammarFingerprint::addMod(h[pos + len], GrammarFingerprint::PRIME - prefix);
+}
+
+// length of the longest table rule whose expansion is the substring of the 
+// block at pos and ends at a fragment boundary or inside a string fragment,
+// 0 if there is none, fragStart holds expansion offsets of the fragments
+int StreamCompressor::matchTable(const CfgRule& start, const vector<int>& fragStart, 
+                                 const vector<unsigned long long>& h, int pos, int& index) {
+    const int m = fragStart.back();
+    if (pos + SEED_LENGTH > m) return 0;
+    typedef multimap<unsigned long long, pair<Fingerprint, int> >::iterator AnchorIt;
+    pair<AnchorIt, AnchorIt> range = anchors.equal_range(substringHash(h, pos, SEED_LENGTH, anchorPower));
+    int bestLen = 0;
+    for (AnchorIt it = range.first; it != range.second; ++it) {
+        const Fingerprint& f = it->second.first;
+        const int end = pos + f.length;
+        if (f.length <= bestLen || end > m) continue;
+        int last = upper_bound(fragStart.begin(), fragStart.end(), end) - fragStart.begin() - 1;
+        if (end != fragStart[last] && start.getFragment(last).isRule) continue;
+        if (substringHash(h, pos, f.length, GrammarFingerprint::power(f.length)) != f.hash) continue;
+        index = it->second.second; bestLen = f.length;
+    }
+    return bestLen;
+}
+
+// encode the part of the start rule of the window: substrings that are 
+// expansions of table rules are replaced by references to them if they do 
+// not cut the rules of the window, the remaining rules are mapped to the table
+void StreamCompressor::encodeStart(CfGrammar* g, const vector<Fingerprint>& fp, vector<int>& global, 
+                                   const CfgRule& start, const char* block, CfgRule& result, ostream& out) {
+    const int numFrags = start.numFragments();
+    vector<int> fragStart(numFrags + 1, 0);
+    for (int i = 0; i < numFrags; ++i) {
+        const RuleFragment& frag = start.getFragment(i);
+        fragStart[i + 1] = fragStart[i] + (frag.isRule ? fp[frag.ruleIndex].length : frag.str.size());
+    }
+    const int m = fragStart[numFrags];
+    // prefix hashes of the block, needed only if there are rules to match
+    vector<unsigned long long> h;
+    if (anchors.empty() == false) {
+        h.resize(m + 1, 0);
+        for (int i = 0; i < m; ++i) 
+            h[i + 1] = GrammarFingerprint::addMod(GrammarFingerprint::mulMod(h[i], GrammarFingerprint::BASE), 
+                                                  (unsigned char)block[i] + 1);
+    }
+    // f is the current fragment, o the offset in it (in strings only),
+    // chars of a string fragment before literal are already in the result
+    int f = 0, o = 0, literal = 0;
+    while (f < numFrags) {
+        const RuleFragment& frag = start.getFragment(f);
+        int index, len = h.empty() ? 0 : matchTable(start, fragStart, h, fragStart[f] + o, index);
+        // a rule of the window with the same expansion is mapped to the same rule
+        if (frag.isRule && len == fragStart[f + 1] - fragStart[f]) len = 0;
+        if (len > 0) {
+            if (o > literal) result.addFragment(subFragment(frag, literal, o - literal));
+            RuleFragment ref; ref.isRule = true; ref.ruleIndex = index;
+            result.addFragment(ref);
+            numSeeded++;
+            const int end = fragStart[f] + o + len;
+            f = upper_bound(fragStart.begin(), fragStart.end(), end) - fragStart.begin() - 1;
+            o = literal = end - fragStart[f];
+        }
+        else if (frag.isRule) {
+            RuleFragment ref = frag;
+            ref.ruleIndex = mapRule(g, fp, global, frag.ruleIndex, out);
+            result.addFragment(ref);
+            f++; o = literal = 0;
+        }
+        else {
+            // without rules to match the rest of the string is added at once
+            o = h.empty() ? frag.str.size() : o + 1;
+            if (o >= (int)frag.str.size()) {
+                if (o > literal) result.addFragment(subFragment(frag, literal, o - literal));
+                f++; o = literal = 0;
+            }
+        }
+    }
+}
+
+void StreamCompressor::writeRecord(ostream& out, char type, int index, const CfgRule& rule) {
+    out.put(type); outputSize++;
+    if (type == 'R') { writeInt(out, index); outputSize += sizeof(int); }
+    CfGrammar::writeRuleBinary(out, rule);
+    outputSize += sizeof(int);
+    for (int i = 0; i < rule.numFragments(); ++i) {
+        const RuleFragment& frag = rule.getFragment(i);
+        outputSize += 1 + sizeof(int) + (frag.isRule ? 0 : frag.str.size());
+    }
+}
+
+// expand rule from the table of decompressed rules
+static void expandRule(map<int, CfgRule>& rules, const CfgRule& rule, ostream& out) {
+    for (int i = 0; i < rule.numFragments(); ++i) {
+        const RuleFragment& frag = rule.getFragment(i);
+        if (frag.isRule) expandRule(rules, rules[frag.ruleIndex], out);
+        else out.write(frag.str.data(), frag.str.size());
+    }
+}
+
+// check that all the rules referenced by the rule are in the table
+static bool rulesDefined(map<int, CfgRule>& rules, const CfgRule& rule) {
+    for (int i = 0; i < rule.numFragments(); ++i) {
+        const RuleFragment& frag = rule.getFragment(i);
+        if (frag.isRule && rules.count(frag.ruleIndex) == 0) return false;
+    }
+    return true;
+}
+
+// decompress the output of compress() record by record, 
+// return false if the input is malformed
+bool StreamCompressor::decompress(istream& in, ostream& out) {
+    char magic[sizeof(STREAM_MAGIC)];
+    in.read(magic, sizeof(magic));
+    if (!in.good() || memcmp(magic, STREAM_MAGIC, sizeof(magic)) != 0) return false;
+    map<int, CfgRule> rules;
+    while (true) {
+        int type = in.get();
+        if (type == EOF) return true;
+        if (type == 'C') rules.clear();
+        else if (type == 'R') {
+            int index; CfgRule rule;
+            if (!readInt(in, index) || rules.count(index) > 0) return false;
+            if (!CfGrammar::readRuleBinary(in, rule, -1) || !rulesDefined(rules, rule)) return false;
+            rules[index] = rule;
+        }
+        else if (type == 'S') {
+            CfgRule rule;
+            if (!CfGrammar::readRuleBinary(in, rule, -1) || !rulesDefined(rules, rule)) return false;
+            expandRule(rules, rule, out);
+        }
+        else return false;
+    }
+}
+
+void StreamCompressor::printStats(ostream& out) {
+    out << "compression_time: " << setprecision(10) << compressionTime;
+    out << " window_size: " << windowSize << " overlap: " << overlap;
+    out << " num_windows: " << numWindows << endl;
+    out << "input_size: " << inputSize << " output_size: " << outputSize;
+    out << " emitted_rules: " << numEmitted << " reused_rules: " << numReused;
+    out << " table_clears: " << numClears << " seeded_refs: " << numSeeded << endl;
+}
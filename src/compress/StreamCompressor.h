@@ -0,0 +1,86 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef STREAMCOMPRESSOR_H
+#define	STREAMCOMPRESSOR_H
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "CfGrammar.h"
+#include "CompressorWorkspace.h"
+#include "GrammarAccess.h"
+#include "GrammarFingerprint.h"
+
+using namespace std;
+
+/* Compresses a stream in windows of bounded size so that memory does not 
+ * depend on the length of the input. Each window is the next block of the 
+ * input preceded by the last overlap chars of the previous window as context.
+ * Window is compressed by LongestFirstSaCompressor with a reused workspace and
+ * only the part of the start rule covering the block is output, rules that 
+ * overlap the context are cut by descending into them. Rules of all windows 
+ * are kept in a table by expansion fingerprint, a rule already in the table 
+ * is output as a reference, the table is cleared when it grows to maxRules.
+ * The block is matched against the table too, so a repeat of an earlier 
+ * window becomes a reference even if the window does not form the same rule:
+ * table rules are indexed by the fingerprint of their first SEED_LENGTH chars,
+ * the longest rule matching at a position is taken if it does not cut a rule 
+ * of the window. Rules shorter than SEED_LENGTH are found only if formed.
+ * Output is written as the windows are compressed: magic followed by records,
+ * 'R' is a new rule (index and body in binary grammar format), 'S' is the 
+ * next part of the start rule and 'C' marks clearing of the rule table. */
+class StreamCompressor {
+public:
+    StreamCompressor(int windowSize, int overlap, int maxRules = 1 << 20);
+    virtual ~StreamCompressor();
+    
+    void compress(istream& in, ostream& out);
+    void printStats(ostream& out);
+    
+    static bool decompress(istream& in, ostream& out);
+    
+    // length of rule prefixes by which strings are matched against the table
+    static const int SEED_LENGTH;
+    
+private:
+    
+    int windowSize, overlap, maxRules;
+    
+    CompressorWorkspace workspace;
+    map<Fingerprint, int> ruleTable; // global rule index by fingerprint
+    // fingerprint and global index of the table rules by fingerprint of their prefix
+    multimap<unsigned long long, pair<Fingerprint, int> > anchors;
+    int nextRule;
+    unsigned long long anchorPower; // BASE^SEED_LENGTH
+    
+    // statistics
+    int numWindows, numEmitted, numReused, numClears, numSeeded;
+    long inputSize, outputSize;
+    double compressionTime;
+    
+    void compressWindow(const string& text, int contextLen, ostream& out);
+    void appendSuffix(CfGrammar* g, GrammarAccess& access, int rule, int offset, CfgRule& out);
+    int mapRule(CfGrammar* g, const vector<Fingerprint>& fp, vector<int>& global, 
+                int rule, ostream& out);
+    void encodeStart(CfGrammar* g, const vector<Fingerprint>& fp, vector<int>& global, 
+                     const CfgRule& start, const char* block, CfgRule& result, ostream& out);
+    int matchTable(const CfgRule& start, const vector<int>& fragStart, 
+                   const vector<unsigned long long>& h, int pos, int& index);
+    void writeRecord(ostream& out, char type, int index, const CfgRule& rule);
+    
+};
+
+#endif	/* STREAMCOMPRESSOR_H */
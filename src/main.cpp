@@ -18,14 +18,32 @@
 #include <fstream>
 #include <cctype>
 #include <iomanip>
+#include <sstream>
 
 #include "suffix/SuffixStructCreator.h"
 #include "suffix/LcpTreeCreator.h"
 #include "compress/radix_sort.h"
 #include "compress/LongestFirstSaCompressor.h"
+#include "compress/GrammarAccess.h"
+#include "compress/GrammarSearch.h"
+#include "compress/RuleInliner.h"
+#include "compress/GrammarBalancer.h"
+#include "compress/DocumentSetCompressor.h"
+#include "compress/StreamCompressor.h"
+#include "compress/GrammarAppender.h"
+#include "compress/DeltaCompressor.h"
+#include "compress/DictionaryCompressor.h"
+#include "compress/GrammarVerifier.h"
 #include "test/Tests.h"
-#include "test/etimer.h"
+#include "util/Profiler.h"
+#include "test/Benchmark.h"
+#include "test/ScalingExperiment.h"
 #include "compress/FastSort.h"
+#include "parallel/BatchCompressor.h"
+#include "parallel/ChunkCompressor.h"
+#include "parallel/CompressionServer.h"
+#include "parallel/RecordPipeline.h"
+#include "parallel/ProgressMonitor.h"
 
 using namespace std;
 
@@ -82,50 +100,672 @@ int main(int argc, char** argv) {
 #endif
 }
 
-char *file;
-bool stats, verbose, ignorews;
+// command line options
+struct ShellOptions {
+    char *file, *outFile, *grammarFile, *batchPath, *docsFile, *appendFile, *refFile, *targetFile;
+    char *trainPath, *dictFile, *serverPath, *clientPath, *recordFraming, *baselineFile, *profileFile;
+    char *verifyFile;
+    string statsFile, benchSizes, benchCorpora, statusFile, checkpointFile;
+    bool stats, verbose, ignorews, decompress, listPositions, inlineRules, balance, renumber, stream;
+    bool serverStats, serverShutdown, bench, perfCounters, estimate, verify, json, resume;
+    int inlineThreshold, numThreads, chunkSize, docIndex, windowSize, windowOverlap, dictSize, queueSize;
+    int sampleSize, spotChecks, scalingParts;
+    int recordBatch, repetitions, warmup;
+    long memLimit, workBudget;
+    double tolerance, progressInterval, deadline, checkpointInterval;
+    vector<AccessRange> accessRanges;
+    vector<string> searchPatterns;
+    
+    ShellOptions();
+};
+
+// default values of the options
+ShellOptions::ShellOptions(): 
+        file(0), outFile(0), grammarFile(0), batchPath(0), docsFile(0), appendFile(0), 
+        refFile(0), targetFile(0), trainPath(0), dictFile(0), serverPath(0), clientPath(0), 
+        recordFraming(0), baselineFile(0), profileFile(0), verifyFile(0), 
+        statsFile("stats.txt"), benchSizes("65536,262144,1048576"), 
+        benchCorpora("random,fibonacci,thue-morse,dna,runs,text"), stats(false), 
+        verbose(false), ignorews(false), decompress(false), listPositions(false), 
+        inlineRules(false), balance(false), renumber(false), stream(false), 
+        serverStats(false), serverShutdown(false), bench(false), perfCounters(false), 
+        estimate(false), verify(false), json(false), resume(false), inlineThreshold(1), 
+        numThreads(sysconf(_SC_NPROCESSORS_ONLN)), chunkSize(0), docIndex(0), 
+        windowSize(1 << 20), windowOverlap(1 << 16), dictSize(1 << 16), queueSize(0), 
+        sampleSize(1 << 20), spotChecks(0), scalingParts(0), recordBatch(1 << 20), 
+        repetitions(5), warmup(1), memLimit(0), workBudget(0), tolerance(10), 
+        progressInterval(0), deadline(0), checkpointInterval(600) { }
 
 struct StrSize {
     char *str;
     int size;
 };
 
-void scanOptions(int argc, char** argv);
-StrSize readString(char *file);
+ShellOptions scanOptions(int argc, char** argv);
+StrSize readString(char *path, bool ignorews);
 void abortShell();
+void outputGrammar(CfGrammar* cfg, const ShellOptions& opt);
+bool verifyGrammar(CfGrammar* cfg, const char* str, int l, const ShellOptions& opt);
+int grammarShell(const ShellOptions& opt);
+void timeAccess(CfGrammar* cfg);
+void timeDecode(CfGrammar* cfg);
+int batchShell(const ShellOptions& opt);
+int docsShell(const ShellOptions& opt);
+int streamShell(const ShellOptions& opt);
+int deltaShell(const ShellOptions& opt);
+int trainShell(const ShellOptions& opt);
+CfGrammar* loadDictionary(const ShellOptions& opt);
+int serverShell(const ShellOptions& opt);
+int clientShell(int argc, char** argv, const ShellOptions& opt);
+int recordShell(const ShellOptions& opt);
+int benchShell(const ShellOptions& opt);
+int estimateShell(int argc, char** argv, const ShellOptions& opt);
+int scalingShell(const ShellOptions& opt);
+int runShell(int argc, char** argv, const ShellOptions& opt);
 
+// run the shell and write the profile if requested
 int shell(int argc, char** argv) {
-    scanOptions(argc, argv);
+    const ShellOptions opt = scanOptions(argc, argv);
+    if (opt.profileFile != 0) Profiler::enable(true);
+    if (opt.profileFile != 0 && opt.perfCounters) Profiler::enableHardwareCounters(true);
+    int status = runShell(argc, argv, opt);
+    if (opt.profileFile != 0) {
+        ofstream out(opt.profileFile);
+        Profiler::writeJson(out);
+    }
+    return status;
+}
+
+int runShell(int argc, char** argv, const ShellOptions& opt) {
+    if (opt.bench) return benchShell(opt);
+    if (opt.estimate) return estimateShell(argc, argv, opt);
+    if (opt.scalingParts > 0) return scalingShell(opt);
+    if (opt.batchPath != 0) return batchShell(opt);
+    if (opt.trainPath != 0) return trainShell(opt);
+    if (opt.serverPath != 0) return serverShell(opt);
+    if (opt.clientPath != 0) return clientShell(argc, argv, opt);
+    if (opt.docsFile != 0) return docsShell(opt);
+    if (opt.stream) return streamShell(opt);
+    if (opt.recordFraming != 0) return recordShell(opt);
+    if (opt.refFile != 0 && opt.grammarFile == 0) return deltaShell(opt);
+    if (opt.grammarFile != 0) return grammarShell(opt);
     char * str; int l;
-    if (file == 0) {
+    if (opt.file == 0) {
         if (argc < 2) abortShell();
         str = argv[1];
         l = strlen(str);
     }
     else {
-        StrSize ss = readString(file);        
+        StrSize ss = readString(opt.file, opt.ignorews);        
         str = ss.str;
         l = ss.size;
     }    
     // compress
     bool d = false, v = false; 
-    if (verbose) { d = true; v = true; }
+    if (opt.verbose) { d = true; v = true; }
     LongestFirstSaCompressor comp(str, l, d, v);
-    CfGrammar* cfg = comp.compress();
-    // output grammar
-    cout << cfg->toString();    
-    free(str);
-    if (stats) {
-        ofstream ofs("stats.txt");
-        ofs << "compression_time: " << setprecision(10) << getEventTime("core_algo") << endl;        
+    comp.getMemoryUsage().setLimit(opt.memLimit);
+    comp.getMemoryUsage().setResidentTracking(opt.stats);
+    comp.setTimeBudget(opt.deadline);
+    comp.setWorkBudget(opt.workBudget);
+    if (opt.checkpointFile.empty() == false) 
+        comp.setCheckpoint(opt.checkpointFile, opt.checkpointInterval, opt.resume);
+    ChunkCompressor chunkComp(str, l, opt.chunkSize, opt.numThreads);
+    CfGrammar* dict = opt.dictFile != 0 ? loadDictionary(opt) : 0;
+    DictionaryCompressor* dictComp = dict != 0 ? new DictionaryCompressor(dict) : 0;
+    CfGrammar* cfg;
+    int singlePassSize = 0;
+    double singlePassTime = 0;
+    if (dictComp != 0) cfg = dictComp->compress(string(str, l));
+    else if (opt.chunkSize > 0) {
+        cfg = chunkComp.compress();
+        if (opt.stats) { // compress in one pass for comparison
+            // wall time, as the time of the chunk compression
+            double start = getWallTime();
+            CfGrammar* single = comp.compress();
+            singlePassTime = getWallTime() - start;
+            if (single != 0) singlePassSize = single->getSize();
+            delete single;
+        }
+    }
+    else {
+        ProgressMonitor* monitor = 0;
+        if (opt.progressInterval > 0 || opt.statusFile.empty() == false) {
+            monitor = new ProgressMonitor(comp.getProgress(), opt.progressInterval, 
+                                          opt.progressInterval > 0 ? &cerr : 0, opt.statusFile);
+            monitor->start();
+        }
+        cfg = comp.compress();
+        delete monitor; // stops the monitor and writes the final report
+        if (cfg == 0) {
+            long needed = max(comp.getMemoryUsage().getPeak(), LongestFirstSaCompressor::minPeakMemory(l));
+            cerr << "memory limit of " << opt.memLimit << " bytes exceeded, compression needs at least "
+                 << needed << " bytes (" << (double)needed / l << " per char)" << endl;
+            if (opt.file != 0) free(str);
+            delete dictComp; delete dict;
+            return 1;
+        }
+        if (comp.getResumedLcp() > 0) cerr << "resumed from checkpoint at lcp " << comp.getResumedLcp() << endl;
+        else if (opt.resume) cerr << "no usable checkpoint, compression started from the beginning" << endl;
+        if (comp.getCheckpointErrors() > 0) cerr << comp.getCheckpointErrors() << " checkpoints could not be written" << endl;
+        if (comp.isPartial()) {
+            cerr << "budget exhausted, rule forming stopped at lcp " << comp.getProgress().lcpLevel 
+                 << ", grammar holds the rules formed until then" << endl;
+        }
+    }
+    // cpu times of decoding and access before and after grammar transformations
+    double inlineTimes[2] = { 0, 0 }, balanceTimes[2] = { 0, 0 }, renumberTimes[2] = { 0, 0 };
+    RuleInliner inliner(opt.inlineThreshold);
+    if (opt.inlineRules) {
+        CfGrammar* inlined = inliner.inlineRules(cfg);
+        if (opt.stats) { // measure decoding time before and after inlining
+            double start = getThreadTime(); cfg->expand(); inlineTimes[0] = getThreadTime() - start;
+            start = getThreadTime(); inlined->expand(); inlineTimes[1] = getThreadTime() - start;
+        }
+        inlined->copyReferenceFingerprint(*cfg);
+        delete cfg;
+        cfg = inlined;
+    }
+    GrammarBalancer balancer;
+    if (opt.balance) {
+        CfGrammar* balanced = balancer.balance(cfg);
+        if (opt.stats) { // measure random access time before and after balancing
+            double start = getThreadTime(); timeAccess(cfg); balanceTimes[0] = getThreadTime() - start;
+            start = getThreadTime(); timeAccess(balanced); balanceTimes[1] = getThreadTime() - start;
+        }
+        balanced->copyReferenceFingerprint(*cfg);
+        delete cfg;
+        cfg = balanced;
+    }
+    if (opt.renumber) {
+        double start = getThreadTime();
+        if (opt.stats) { timeDecode(cfg); renumberTimes[0] = getThreadTime() - start; }
+        cfg->renumberByFirstUse();
+        start = getThreadTime();
+        if (opt.stats) { timeDecode(cfg); renumberTimes[1] = getThreadTime() - start; }
+    }
+    if (opt.verify && !verifyGrammar(cfg, str, l, opt)) {
+        if (opt.file != 0) free(str);
+        delete cfg; delete dictComp; delete dict;
+        return 1;
+    }
+    outputGrammar(cfg, opt);
+    // the grammar is written, checkpoint is no longer needed
+    if (opt.checkpointFile.empty() == false && opt.chunkSize == 0 && dictComp == 0) 
+        unlink(opt.checkpointFile.c_str());
+    if (opt.file != 0) free(str);
+    if (opt.stats) {
+        ofstream ofs(opt.statsFile.c_str());
+        if (dictComp != 0) dictComp->printStats(ofs);
+        else if (opt.chunkSize > 0) chunkComp.printStats(ofs);
+        else ofs << "compression_time: " << setprecision(10) << comp.getCompressionTime() << endl;        
         cfg->printSize(ofs); ofs << endl;
-        comp.printStats(ofs);
+        if (dictComp == 0) comp.printStats(ofs);
+        if (dictComp == 0 && opt.chunkSize == 0) comp.getMemoryUsage().printStats(ofs, l);
+        if (opt.chunkSize > 0) {
+            ofs << "single_pass_time: " << singlePassTime;
+            ofs << " single_pass_size: " << singlePassSize;
+            // no ratio if the single pass grammar is missing or empty
+            ofs << " ratio_loss: ";
+            if (singlePassSize > 0) ofs << (double)cfg->getSize() / singlePassSize - 1 << endl;
+            else ofs << "n/a" << endl;
+        }
+        if (opt.inlineRules) {
+            inliner.printStats(ofs);
+            ofs << "decode_time_before_inline: " << inlineTimes[0];
+            ofs << " decode_time_after_inline: " << inlineTimes[1] << endl;
+        }
+        if (opt.balance) {
+            balancer.printStats(ofs);
+            ofs << "access_time_before_balance: " << balanceTimes[0];
+            ofs << " access_time_after_balance: " << balanceTimes[1] << endl;
+        }
+        if (opt.renumber) {
+            ofs << "decode_time_before_renumber: " << renumberTimes[0];
+            ofs << " decode_time_after_renumber: " << renumberTimes[1] << endl;
+        }
     }    
     delete cfg;     
+    delete dictComp; delete dict;
+
+    return 0;
+}
+
+// compress files from a folder or a list in parallel
+int batchShell(const ShellOptions& opt) {
+    BatchCompressor batch(opt.numThreads, opt.outFile ? opt.outFile : ".", opt.ignorews);
+    if (!batch.addFiles(opt.batchPath)) {
+        cout << "error reading batch folder or list" << endl;
+        abortShell();
+    }
+    int failed = batch.run();
+    if (failed > 0) cout << failed << " files failed" << endl;
+    return failed > 0 ? 1 : 0;
+}
+
+// compress documents from a file, one per line, with shared rules
+int docsShell(const ShellOptions& opt) {
+    ifstream in(opt.docsFile);
+    if (!in) {
+        cout << "error reading documents file" << endl;
+        abortShell();
+    }
+    vector<string> docs;
+    string line;
+    while (getline(in, line)) docs.push_back(line);
+    DocumentSetCompressor comp(docs);
+    CfGrammar* cfg = comp.compress();
+    if (cfg == 0) {
+        cout << "documents contain all the chars, no separator can be used" << endl;
+        return 1;
+    }
+    outputGrammar(cfg, opt);
+    if (opt.stats) {
+        ofstream ofs(opt.statsFile.c_str());
+        comp.printStats(ofs);
+        cfg->printSize(ofs); ofs << endl;
+    }
+    delete cfg;
+    return 0;
+}
+
+// compress file or standard input in windows, or decompress with -d
+int streamShell(const ShellOptions& opt) {
+    ifstream fin; ofstream fout;
+    if (opt.file != 0) {
+        fin.open(opt.file, ios::binary);
+        if (!fin) {
+            cout << "error reading file" << endl;
+            abortShell();
+        }
+    }
+    if (opt.outFile != 0) fout.open(opt.outFile, ios::binary);
+    istream& in = opt.file != 0 ? (istream&)fin : cin;
+    ostream& out = opt.outFile != 0 ? (ostream&)fout : cout;
+    if (opt.decompress) {
+        if (!StreamCompressor::decompress(in, out)) {
+            cerr << "error reading compressed stream" << endl;
+            return 1;
+        }
+        return 0;
+    }
+    StreamCompressor comp(opt.windowSize, opt.windowOverlap);
+    comp.compress(in, out);
+    if (opt.stats) {
+        ofstream ofs(opt.statsFile.c_str());
+        comp.printStats(ofs);
+    }
+    return 0;
+}
+
+// time compression phases on generated corpora and a file, write results 
+// as JSON and compare them with a baseline, exit status is 2 on regression
+int benchShell(const ShellOptions& opt) {
+    Benchmark bench(opt.repetitions, opt.warmup);
+    vector<int> sizes;
+    istringstream sizeList(opt.benchSizes);
+    string item;
+    while (getline(sizeList, item, ',')) if (atoi(item.c_str()) > 0) sizes.push_back(atoi(item.c_str()));
+    istringstream corpusList(opt.benchCorpora);
+    while (getline(corpusList, item, ',')) {
+        if (!Benchmark::isCorpus(item)) {
+            cout << "unknown corpus " << item << endl;
+            abortShell();
+        }
+        for (int i = 0; i < sizes.size(); ++i) bench.addCorpus(item, sizes[i]);
+    }
+    if (opt.file != 0) {
+        StrSize ss = readString(opt.file, opt.ignorews);
+        bench.addFile(opt.file, string(ss.str, ss.size));
+        free(ss.str);
+    }
+    bench.run(cout);
+    ofstream out(opt.outFile != 0 ? opt.outFile : "bench.json");
+    bench.writeJson(out);
+    if (opt.baselineFile != 0) {
+        ifstream baseline(opt.baselineFile);
+        if (!baseline) {
+            cout << "error reading baseline" << endl;
+            return 1;
+        }
+        if (bench.compare(baseline, opt.tolerance / 100, cout) > 0) return 2;
+    }
+    return 0;
+}
+
+// predict time, peak memory and grammar size of one pass compression without 
+// forming the rules, exit status is 1 if the memory limit would be exceeded
+int estimateShell(int argc, char** argv, const ShellOptions& opt) {
+    char * str; int l;
+    if (opt.file == 0) {
+        if (argc < 2) abortShell();
+        str = argv[1];
+        l = strlen(str);
+    }
+    else {
+        StrSize ss = readString(opt.file, opt.ignorews);        
+        str = ss.str;
+        l = ss.size;
+    }
+    LongestFirstSaCompressor comp(str, l);
+    LongestFirstSaCompressor::CostEstimate e = comp.estimate(opt.sampleSize);
+    e.print(cout);
+    if (opt.file != 0) free(str);
+    if (opt.memLimit > 0 && e.peakMemory > opt.memLimit) {
+        cerr << "memory limit of " << opt.memLimit << " bytes would be exceeded, compression needs about "
+             << e.peakMemory << " bytes (" << (double)e.peakMemory / l << " per char)" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// compress prefixes of 1/N..N/N of the file in process, write the table of 
+// phase times and tree statistics and fit the complexity exponents
+int scalingShell(const ShellOptions& opt) {
+    if (opt.file == 0) {
+        cout << "file for the scaling experiment is missing" << endl;
+        abortShell();
+    }
+    StrSize ss = readString(opt.file, opt.ignorews);
+    string text(ss.str, ss.size);
+    free(ss.str);
+    ScalingExperiment experiment(text, opt.scalingParts);
+    experiment.run(cout);
+    ofstream out(opt.outFile != 0 ? opt.outFile : (opt.json ? "scaling.json" : "scaling.csv"));
+    if (opt.json) experiment.writeJson(out);
+    else experiment.writeCsv(out);
+    experiment.printFit(cout);
+    return 0;
+}
 
+// compress records from file or standard input in a pipeline, or decompress with -d
+int recordShell(const ShellOptions& opt) {
+    RecordPipeline::Framing framing = RecordPipeline::LINES;
+    if (strcmp(opt.recordFraming, "lines") == 0) framing = RecordPipeline::LINES;
+    else if (strcmp(opt.recordFraming, "length") == 0) framing = RecordPipeline::LENGTH_PREFIXED;
+    else abortShell();
+    ifstream fin; ofstream fout;
+    if (opt.file != 0) {
+        fin.open(opt.file, ios::binary);
+        if (!fin) {
+            cout << "error reading file" << endl;
+            abortShell();
+        }
+    }
+    if (opt.outFile != 0) fout.open(opt.outFile, ios::binary);
+    istream& in = opt.file != 0 ? (istream&)fin : cin;
+    ostream& out = opt.outFile != 0 ? (ostream&)fout : cout;
+    if (opt.decompress) {
+        if (!RecordPipeline::decompress(in, out, framing)) {
+            cerr << "error reading compressed records" << endl;
+            return 1;
+        }
+        return 0;
+    }
+    RecordPipeline pipeline(framing, opt.recordBatch, opt.numThreads, opt.queueSize > 0 ? opt.queueSize : 2);
+    bool ok = pipeline.compress(in, out);
+    if (opt.stats) {
+        ofstream ofs(opt.statsFile.c_str());
+        pipeline.printStats(ofs);
+    }
+    if (!ok) {
+        cerr << "input ends inside a record" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// run compression server until shutdown request
+int serverShell(const ShellOptions& opt) {
+    CompressionServer server(opt.serverPath, opt.numThreads, opt.queueSize);
+    if (!server.run()) {
+        cout << "error creating socket" << endl;
+        return 1;
+    }
     return 0;
 }
 
+// send one request to the server and output the response: compress 
+// string or file, decompress grammar file with -d, server statistics
+int clientShell(int argc, char** argv, const ShellOptions& opt) {
+    char type; string payload;
+    if (opt.serverStats) type = CompressionServer::STATS;
+    else if (opt.serverShutdown) type = CompressionServer::SHUTDOWN;
+    else {
+        type = opt.decompress ? CompressionServer::DECOMPRESS : CompressionServer::COMPRESS;
+        if (opt.file != 0) {
+            if (!BatchCompressor::readFile(opt.file, payload, opt.ignorews && !opt.decompress)) {
+                cout << "error reading file" << endl;
+                abortShell();
+            }
+        }
+        else if (argc > 1 && argv[1][0] != '-') payload = argv[1];
+        else abortShell();
+    }
+    char status; string response;
+    if (!CompressionServer::request(opt.clientPath, type, payload, status, response)) {
+        cout << "error connecting to server" << endl;
+        return 1;
+    }
+    if (status != CompressionServer::OK) {
+        cout << "server error: " << response << endl;
+        return 1;
+    }
+    if (opt.outFile != 0) {
+        ofstream out(opt.outFile, ios::binary);
+        out << response;
+    }
+    else if (type == CompressionServer::COMPRESS) { // print grammar as text
+        istringstream in(response);
+        CfGrammar* cfg = CfGrammar::readBinary(in);
+        if (cfg == 0) {
+            cout << "malformed grammar in server response" << endl;
+            return 1;
+        }
+        cout << cfg->toString();
+        delete cfg;
+    }
+    else cout << response;
+    return 0;
+}
+
+// train dictionary on files from a folder or a list
+int trainShell(const ShellOptions& opt) {
+    vector<string> files, samples;
+    if (!BatchCompressor::listFiles(opt.trainPath, files)) {
+        cout << "error reading training folder or list" << endl;
+        abortShell();
+    }
+    for (int i = 0; i < files.size(); ++i) {
+        string sample;
+        if (BatchCompressor::readFile(files[i], sample, opt.ignorews)) samples.push_back(sample);
+    }
+    CfGrammar* dict = DictionaryCompressor::train(samples, opt.dictSize);
+    if (dict == 0) {
+        cout << "samples contain all the chars, no separator can be used" << endl;
+        return 1;
+    }
+    outputGrammar(dict, opt);
+    if (opt.stats) {
+        ofstream ofs(opt.statsFile.c_str());
+        ofs << "num_samples: " << samples.size() << " dictionary_entries: " 
+            << dict->getNumRules() - 1 << " dictionary_size: " << dict->expand().size() << endl;
+    }
+    delete dict;
+    return 0;
+}
+
+// load dictionary created with --train, abort if it can't be read
+CfGrammar* loadDictionary(const ShellOptions& opt) {
+    ifstream in(opt.dictFile, ios::binary);
+    CfGrammar* dict = CfGrammar::readBinary(in);
+    if (dict == 0) {
+        cout << "error reading dictionary file" << endl;
+        abortShell();
+    }
+    return dict;
+}
+
+// compress target file against reference file
+int deltaShell(const ShellOptions& opt) {
+    if (opt.targetFile == 0) abortShell();
+    StrSize ref = readString(opt.refFile, opt.ignorews), target = readString(opt.targetFile, opt.ignorews);
+    string refStr(ref.str, ref.size), targetStr(target.str, target.size);
+    free(ref.str); free(target.str);
+    DeltaCompressor comp(refStr, targetStr);
+    CfGrammar* cfg = comp.compress();
+    if (cfg == 0) {
+        cout << "files contain all the chars, no separator can be used" << endl;
+        return 1;
+    }
+    outputGrammar(cfg, opt);
+    if (opt.stats) {
+        ofstream ofs(opt.statsFile.c_str());
+        comp.printStats(ofs);
+        cfg->printSize(ofs); ofs << endl;
+    }
+    delete cfg;
+    return 0;
+}
+
+// load grammar in binary format and output it or query it
+int grammarShell(const ShellOptions& opt) {
+    ifstream in(opt.grammarFile, ios::binary);
+    CfGrammar* cfg;
+    {
+        ProfileScope scope("read_grammar");
+        cfg = CfGrammar::readBinary(in);
+    }
+    if (cfg == 0) {
+        cout << "error reading grammar file" << endl;
+        abortShell();
+    }
+    if (opt.refFile != 0) { // grammar created with --ref references the reference text
+        StrSize ref = readString(opt.refFile, opt.ignorews);
+        bool ok = cfg->setReferenceText(string(ref.str, ref.size));
+        free(ref.str);
+        if (!ok) {
+            cout << "grammar does not match the reference file" << endl;
+            delete cfg;
+            return 1;
+        }
+    }
+    if (opt.dictFile != 0) { // grammar compressed with dictionary references its text
+        CfGrammar* dict = loadDictionary(opt);
+        DictionaryCompressor dictComp(dict);
+        bool ok = cfg->setReferenceText(dictComp.getText());
+        delete dict;
+        if (!ok) {
+            cout << "grammar does not match the dictionary" << endl;
+            delete cfg;
+            return 1;
+        }
+    }
+    GrammarAppender* appender = 0;
+    if (opt.appendFile != 0) { // compress the tail reusing the rules of the grammar
+        StrSize tail = readString(opt.appendFile, opt.ignorews);
+        appender = new GrammarAppender(cfg);
+        CfGrammar* appended = appender->append(string(tail.str, tail.size));
+        free(tail.str);
+        delete cfg;
+        cfg = appended;
+    }
+    if (opt.verify) {
+        if (opt.verifyFile == 0) {
+            cout << "file to verify the grammar against is missing" << endl;
+            abortShell();
+        }
+        if (!verifyGrammar(cfg, 0, 0, opt)) {
+            delete appender; delete cfg;
+            return 1;
+        }
+    }
+    outputGrammar(cfg, opt);
+    if (opt.stats) {
+        ofstream ofs(opt.statsFile.c_str());
+        if (appender != 0) appender->printStats(ofs);
+        cfg->printSize(ofs); ofs << endl;
+    }
+    delete appender;
+    delete cfg;
+    return 0;
+}
+
+// output grammar or the results of the queries, depending on options
+void outputGrammar(CfGrammar* cfg, const ShellOptions& opt) {
+    ProfileScope scope("output");
+    if (opt.outFile != 0) {
+        ofstream out(opt.outFile, ios::binary);
+        cfg->writeBinary(out);
+    }
+    if (opt.accessRanges.empty() == false) {
+        GrammarAccess access(cfg);
+        vector<string> result = access.extract(opt.accessRanges);
+        for (int i = 0; i < result.size(); ++i) cout << result[i] << endl;
+    }
+    else if (opt.searchPatterns.empty() == false) {
+        GrammarSearch search(cfg);
+        for (int i = 0; i < opt.searchPatterns.size(); ++i) search.addPattern(opt.searchPatterns[i]);
+        for (int i = 0; i < opt.searchPatterns.size(); ++i) {
+            cout << opt.searchPatterns[i] << " " << search.count(i);
+            if (opt.listPositions) {
+                vector<int> pos = search.positions(i);
+                for (int j = 0; j < pos.size(); ++j) cout << " " << pos[j];
+            }
+            cout << endl;
+        }
+    }
+    else if (opt.docIndex > 0) {
+        if (opt.docIndex < cfg->getNumRules()) cout << cfg->expand(opt.docIndex);
+        else cout << "no document " << opt.docIndex << endl;
+    }
+    else if (opt.decompress) cout << cfg->expand();
+    else if (opt.outFile == 0 && !opt.verify) cout << cfg->toString();
+}
+
+// verify the grammar against the string, or against opt.verifyFile if str 
+// is 0, without expanding the grammar, and report the result to stderr
+bool verifyGrammar(CfGrammar* cfg, const char* str, int l, const ShellOptions& opt) {
+    const int spotLength = 64;
+    GrammarVerifier verifier(cfg);
+    bool ok; int failed = 0;
+    if (str != 0) {
+        ok = verifier.verify(str, l);
+        if (opt.spotChecks > 0) failed = verifier.spotCheck(str, l, opt.spotChecks, spotLength);
+    }
+    else {
+        ifstream in(opt.verifyFile, ios::binary);
+        if (!in) {
+            cerr << "error reading file to verify" << endl;
+            return false;
+        }
+        if (opt.spotChecks > 0) failed = verifier.spotCheck(in, opt.spotChecks, spotLength);
+        ok = verifier.verify(in);
+    }
+    verifier.printStats(cerr);
+    if (!ok) cerr << "verification failed, fingerprint or length of the grammar does not match the input" << endl;
+    if (failed > 0) cerr << "verification failed, " << failed << " of " << opt.spotChecks << " spot checks do not match" << endl;
+    return ok && failed == 0;
+}
+
+// perform a fixed series of random access queries, for timing
+void timeAccess(CfGrammar* cfg) {
+    const int numQueries = 100000, len = 16;
+    GrammarAccess access(cfg);
+    int N = access.length();
+    srand(1);
+    for (int i = 0; i < numQueries; ++i) access.extract(rand() % N, len);
+}
+
+// decode the whole grammar a fixed number of times, for timing
+void timeDecode(CfGrammar* cfg) {
+    const int repeat = 10;
+    for (int i = 0; i < repeat; ++i) {
+        GrammarAccess access(cfg);
+        access.extract(0, access.length());
+    }
+}
+
 void printUsage() {
     const char* message = 
     "cfg_esa - longest first grammar compression with suffix array\n"
@@ -133,33 +773,302 @@ void printUsage() {
     "usage: \n"
     "   cfg_esa string [-s -v -w] - pass string as argument\n"
     "   cfg_esa -f file [-s -v -w] - read string from file\n"
+    "   cfg_esa -g file [-s -d -a offset length -p pattern -l] - read grammar in binary format\n"
+    "   cfg_esa -g file --append file [-o file -s] - append contents of a file to the string\n"
+    "      of the grammar, reusing the rules of the grammar\n"
+    "   cfg_esa --ref reference target [-o file -s] - compress target file against reference\n"
+    "      file, grammar of the target references substrings of the reference, use\n"
+    "      -g file --ref reference to load such a grammar\n"
+    "   cfg_esa --train folder|list -o file [--dict-size bytes -s] - train dictionary on files\n"
+    "      in a folder or listed in a file, use --dict file when compressing a string\n"
+    "      to reference dictionary entries, and with -g to load such a grammar\n"
+    "   cfg_esa --server socket [-t threads --queue n] - run compression server on a Unix\n"
+    "      socket, n is the number of connections waiting for a worker\n"
+    "   cfg_esa string --client socket [-o file], cfg_esa --client socket -f file [-d -o file]\n"
+    "      - compress string or file on the server, -d decompresses grammar file,\n"
+    "      -o writes the response to file\n"
+    "   cfg_esa --client socket --server-stats | --shutdown - server statistics or shutdown\n"
+    "   cfg_esa --docs file [-s -o file] - compress documents, one per line, with shared\n"
+    "      rules, rule Ri is the start rule of i-th document\n"
+    "   cfg_esa --stream [-f file -o file --window bytes --overlap bytes -s] - compress\n"
+    "      file or standard input in windows with bounded memory, output is written\n"
+    "      to file or standard output as the windows are compressed, use -d to decompress\n"
+    "   cfg_esa --records lines|length [-f file -o file --record-batch bytes -t threads\n"
+    "      --queue n -s -d] - compress newline delimited or 4 byte length prefixed records\n"
+    "      from file or standard input in batches, reading, compression on -t threads and\n"
+    "      writing run in a pipeline with queues of n batches, records of a batch are\n"
+    "      compressed together into one grammar, -d decompresses the records\n"
+    "   cfg_esa --bench [--corpora list --sizes list --reps n --warmup n -f file -o file\n"
+    "      --baseline file --tolerance percent] - time compression phases, output and\n"
+    "      decompression on generated corpora (random, fibonacci, thue-morse, dna, runs,\n"
+    "      text) of given sizes (comma separated lists) and on a file, results are\n"
+    "      written as JSON to bench.json or -o file, with --baseline phases slower than\n"
+    "      in the baseline results by more than tolerance (default 10%) are reported\n"
+    "   cfg_esa --scaling parts -f file [-o file --json] - compress prefixes of 1/parts,\n"
+    "      2/parts... of the file in one process with reused buffers, times of the phases,\n"
+    "      interval tree size, sum of tree depths, alpha, rules, grammar size and peak\n"
+    "      memory of each prefix are written as CSV to scaling.csv or -o file (JSON with\n"
+    "      --json), exponents of length fitted to time, depths, size and memory are printed\n"
+    "   cfg_esa --batch folder|list [-t threads -o folder -w] - compress all files in a folder\n"
+    "      or listed in a file (one per line) in parallel, grammars are written in binary\n"
+    "      format to output folder (default is current) with statistics in batch_stats.txt,\n"
+    "      files with equal names from different folders get suffixes name-2.cfg, name-3.cfg\n"
     "   use -s to print compression time and other statistics to stats.txt\n"
+    "   use --stats-file file to print statistics to file instead of stats.txt\n"
+    "   use --mem-limit bytes[k|m|g] to stop one pass compression with an error if its\n"
+    "      structures would need more memory, -s prints peak memory per structure and phase\n"
+    "   use --deadline seconds or --work-budget positions to stop rule forming of one pass\n"
+    "      compression when the wall time since its start or the interval positions processed\n"
+    "      (see sum_of_tree_depths in statistics) exceed the budget, the grammar then holds\n"
+    "      the rules formed until the stop, -s prints the lcp level and work done\n"
+    "   use --checkpoint file [--checkpoint-interval seconds] to write the state of rule\n"
+    "      forming of one pass compression to file at lcp level boundaries, at most once\n"
+    "      per interval (default 600), the file is removed when the grammar is written,\n"
+    "      with --resume compression continues from the checkpoint in file if it is intact\n"
+    "      and was written for the same string, the grammar is the same as without resume\n"
+    "   use --progress seconds to report phase, lcp level, intervals done, rules, rate and\n"
+    "      eta (seconds, -1 if unknown) of one pass compression to stderr periodically,\n"
+    "      --status-file file writes the report to file instead (each second by default)\n"
+    "   use --profile file to write wall and cpu time of nested phases of all threads\n"
+    "      and algorithm counters (intervals, positions, rules...) to file as JSON\n"
+    "   use --perf with --profile to add cycles, instructions, llc, dtlb and branch misses\n"
+    "      of each phase, counters that perf_event_open can not open are left out\n"
+    "   use --estimate [--sample chars] to build the suffix structures and predict time,\n"
+    "      peak memory and grammar size of one pass compression without compressing,\n"
+    "      rule forming time and grammar growth are calibrated by compressing prefixes of\n"
+    "      chars (default 1048576) and half as many chars, with --mem-limit exit status\n"
+    "      is 1 if the predicted peak memory exceeds the limit\n"
+    "   use --verify [--spot-checks n] to check the output grammar against the input by\n"
+    "      Karp-Rabin fingerprints, without expanding it, and n substrings at random offsets\n"
+    "      extracted by rule descent, use -g file --verify input to check a grammar file,\n"
+    "      the result is written to stderr and exit status is 1 if the grammar does not match\n"
+    "   use --chunk-size bytes to compress chunks of the string in parallel on -t threads\n"
+    "      and merge the chunk grammars, -s compares the size with one pass compression\n"
     "   use -v option for verbose output of algorithm work\n"
-    "   use -w option to ignore whitespace characters when reading from file\n";
+    "   use -w option to ignore whitespace characters when reading from file\n"
+    "   use -o file to write the grammar to file in binary format\n"
+    "   use -d to output expanded (decompressed) string instead of the grammar\n"
+    "   use --doc i to output i-th document of a grammar created with --docs\n"
+    "   use -a offset length to output a substring of the expanded string,\n"
+    "      option can be repeated to extract a batch of substrings\n"
+    "   use -p pattern to output the number of occurrences of the pattern,\n"
+    "      option can be repeated to search for many patterns in one pass\n"
+    "   use -l with -p to also output positions of the occurrences\n"
+    "   use -i threshold to inline rules saving less than threshold symbols\n"
+    "   use -b to balance the grammar to height O(log N) for faster random access\n"
+    "   use -r to renumber the rules by first use, for locality of decoding\n";
     cout<<message<<endl;
 }
 // abort shell 
 void abortShell() { printUsage(); exit(1); }
 
 // scan command line options and set parameter variables
-void scanOptions(int argc, char** argv) {
-    stats = false; verbose = false; ignorews = false; file = 0;
+ShellOptions scanOptions(int argc, char** argv) {
+    ShellOptions opt;
     for (int i = 1; i < argc; ++i) {
         //cout << argv[i] << endl;
         string s = argv[i];        
-        if (s == "-v") verbose = true;
-        if (s == "-s") stats = true;
-        if (s == "-w") ignorews = true;
+        if (s == "-v") opt.verbose = true;
+        if (s == "-s") opt.stats = true;
+        if (s == "-w") opt.ignorews = true;
+        if (s == "-d") opt.decompress = true;
+        if (s == "-l") opt.listPositions = true;
+        if (s == "-b") opt.balance = true;
+        if (s == "-r") opt.renumber = true;
+        if (s == "--stream") opt.stream = true;
+        if (s == "--window") {
+            if (i < argc-1) opt.windowSize = atoi(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--overlap") {
+            if (i < argc-1) opt.windowOverlap = atoi(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--batch") {
+            if (i < argc-1) opt.batchPath = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--ref") { // target file is optional, not needed with -g
+            if (i < argc-1) opt.refFile = argv[i+1];
+            else abortShell();
+            if (i < argc-2 && argv[i+2][0] != '-') opt.targetFile = argv[i+2];
+        }
+        if (s == "--stats-file") {
+            if (i < argc-1) opt.statsFile = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--bench") opt.bench = true;
+        if (s == "--perf") opt.perfCounters = true;
+        if (s == "--estimate") opt.estimate = true;
+        if (s == "--json") opt.json = true;
+        if (s == "--resume") opt.resume = true;
+        if (s == "--checkpoint") {
+            if (i < argc-1) opt.checkpointFile = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--checkpoint-interval") {
+            if (i < argc-1) opt.checkpointInterval = atof(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--deadline") {
+            if (i < argc-1) opt.deadline = atof(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--work-budget") {
+            if (i < argc-1) opt.workBudget = atol(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--scaling") {
+            if (i < argc-1) opt.scalingParts = atoi(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--verify") {
+            opt.verify = true;
+            if (i < argc-1 && argv[i+1][0] != '-') opt.verifyFile = argv[i+1];
+        }
+        if (s == "--spot-checks") {
+            if (i < argc-1) opt.spotChecks = atoi(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--sample") {
+            if (i < argc-1) opt.sampleSize = atoi(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--progress") {
+            if (i < argc-1) opt.progressInterval = atof(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--status-file") {
+            if (i < argc-1) opt.statusFile = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--mem-limit") { // bytes, with optional k, m or g suffix
+            if (i < argc-1) {
+                char* suffix;
+                opt.memLimit = strtol(argv[i+1], &suffix, 10);
+                if (*suffix == 'k' || *suffix == 'K') opt.memLimit <<= 10;
+                if (*suffix == 'm' || *suffix == 'M') opt.memLimit <<= 20;
+                if (*suffix == 'g' || *suffix == 'G') opt.memLimit <<= 30;
+            }
+            else abortShell();
+        }
+        if (s == "--profile") {
+            if (i < argc-1) opt.profileFile = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--sizes") {
+            if (i < argc-1) opt.benchSizes = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--corpora") {
+            if (i < argc-1) opt.benchCorpora = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--reps") {
+            if (i < argc-1) opt.repetitions = atoi(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--warmup") {
+            if (i < argc-1) opt.warmup = atoi(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--baseline") {
+            if (i < argc-1) opt.baselineFile = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--tolerance") {
+            if (i < argc-1) opt.tolerance = atof(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--records") {
+            if (i < argc-1) opt.recordFraming = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--record-batch") {
+            if (i < argc-1) opt.recordBatch = atoi(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--server") {
+            if (i < argc-1) opt.serverPath = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--client") {
+            if (i < argc-1) opt.clientPath = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--queue") {
+            if (i < argc-1) opt.queueSize = atoi(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--server-stats") opt.serverStats = true;
+        if (s == "--shutdown") opt.serverShutdown = true;
+        if (s == "--train") {
+            if (i < argc-1) opt.trainPath = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--dict") {
+            if (i < argc-1) opt.dictFile = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--dict-size") {
+            if (i < argc-1) opt.dictSize = atoi(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--append") {
+            if (i < argc-1) opt.appendFile = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--docs") {
+            if (i < argc-1) opt.docsFile = argv[i+1];
+            else abortShell();
+        }
+        if (s == "--doc") {
+            if (i < argc-1) opt.docIndex = atoi(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "--chunk-size") {
+            if (i < argc-1) opt.chunkSize = atoi(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "-t") {
+            if (i < argc-1) opt.numThreads = atoi(argv[i+1]);
+            else abortShell();
+        }
+        if (s == "-i") {
+            if (i < argc-1) { opt.inlineRules = true; opt.inlineThreshold = atoi(argv[i+1]); }
+            else abortShell();
+        }
+        if (s == "-p") {
+            if (i < argc-1) opt.searchPatterns.push_back(argv[i+1]);
+            else abortShell();
+        }
         if (s == "-f") {
-            if (i < argc-1) file = argv[i+1];
+            if (i < argc-1) opt.file = argv[i+1];
+            else abortShell();
+        }
+        if (s == "-o") {
+            if (i < argc-1) opt.outFile = argv[i+1];
+            else abortShell();
+        }
+        if (s == "-g") {
+            if (i < argc-1) opt.grammarFile = argv[i+1];
+            else abortShell();
+        }
+        if (s == "-a") {
+            if (i < argc-2) { 
+                AccessRange r;
+                r.offset = atoi(argv[i+1]); r.length = atoi(argv[i+2]);
+                opt.accessRanges.push_back(r);
+            }
             else abortShell();
         }
     }    
+    return opt;
 }
 
 // read string from file, consisting of all characters, skipping whitespace
-StrSize readString(char *file) {
-    ifstream fstr(file); 
+StrSize readString(char *path, bool ignorews) {
+    ifstream fstr(path); 
     int L = 10000; int pos = -1;
     char *buff = (char*)malloc(L);
     while (true) {
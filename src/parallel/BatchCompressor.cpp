@@ -0,0 +1,180 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <iomanip>
+#include <cctype>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "BatchCompressor.h"
+#include "compress/LongestFirstSaCompressor.h"
+#include "compress/CompressorWorkspace.h"
+
+BatchCompressor::BatchCompressor(int threads, string out, bool ignoreWs): 
+        numThreads(threads), outFolder(out), ignorews(ignoreWs), numFailed(0) {
+    if (numThreads < 1) numThreads = 1;
+    pthread_mutex_init(&statsMutex, 0);
+}
+
+BatchCompressor::~BatchCompressor() {
+    pthread_mutex_destroy(&statsMutex);
+}
+
+// add files to compress: all regular files in a folder, or files 
+// listed in a file, one per line. return false if path can't be read
+bool BatchCompressor::addFiles(string path) {
+    return listFiles(path, files);
+}
+
+// add to files regular files from a folder or paths listed in a file, 
+// one per line, return false if path can not be read
+bool BatchCompressor::listFiles(const string& path, vector<string>& files) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    if (S_ISDIR(st.st_mode)) {
+        DIR* dir = opendir(path.c_str());
+        if (dir == 0) return false;
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != 0) {
+            string file = path + "/" + entry->d_name;
+            struct stat fst;
+            if (stat(file.c_str(), &fst) == 0 && S_ISREG(fst.st_mode)) files.push_back(file);
+        }
+        closedir(dir);
+    }
+    else {
+        ifstream list(path.c_str());
+        string line;
+        while (getline(list, line)) {
+            if (line.empty() == false) files.push_back(line);
+        }
+    }
+    return true;
+}
+
+// pair (file size, file name), for sorting files by size
+typedef pair<long, string> SizedFile;
+
+// compress all the files, return number of files that failed
+int BatchCompressor::run() {
+    // schedule largest files first, each file once
+    assignOutputs();
+    vector<SizedFile> sized;
+    set<string> scheduled;
+    for (int i = 0; i < files.size(); ++i) {
+        if (scheduled.insert(files[i]).second == false) continue;
+        struct stat st; long size = 0;
+        if (stat(files[i].c_str(), &st) == 0) size = st.st_size;
+        sized.push_back(SizedFile(size, files[i]));
+    }
+    sort(sized.rbegin(), sized.rend());
+    for (int i = 0; i < sized.size(); ++i) queue.push(sized[i].second);
+    queue.close();
+    
+    statsFile.open((outFolder + "/batch_stats.txt").c_str());
+    vector<pthread_t> threads(numThreads);
+    for (int i = 0; i < numThreads; ++i) pthread_create(&threads[i], 0, workerMain, this);
+    for (int i = 0; i < numThreads; ++i) pthread_join(threads[i], 0);
+    statsFile.close();
+    return numFailed;
+}
+
+// name outputs after the input files, in the order the files were added, 
+// a file whose name is already taken gets the first free suffix -2, -3, ...
+void BatchCompressor::assignOutputs() {
+    outputs.clear();
+    set<string> taken;
+    for (int i = 0; i < files.size(); ++i) {
+        if (outputs.count(files[i]) > 0) continue; // listed twice
+        string name = baseName(files[i]);
+        string out = name;
+        for (int k = 2; taken.count(out) > 0; ++k) {
+            ostringstream s; s << name << "-" << k;
+            out = s.str();
+        }
+        taken.insert(out);
+        outputs[files[i]] = outFolder + "/" + out + ".cfg";
+    }
+}
+
+void* BatchCompressor::workerMain(void* batch) {
+    ((BatchCompressor*)batch)->work();
+    return 0;
+}
+
+// worker loop, compress files from the queue until it is empty
+void BatchCompressor::work() {
+    CompressorWorkspace workspace;
+    string str, file;
+    while (queue.pop(file)) {
+        ostringstream record;
+        record << "file: " << file;
+        if (!readFile(file, str, ignorews)) {
+            writeStats(record.str() + " error: read_failed", false);
+            continue;
+        }
+        LongestFirstSaCompressor comp(str.c_str(), str.size(), false, false, &workspace);
+        CfGrammar* cfg = comp.compress();
+        const string& outFile = outputs.find(file)->second;
+        record << " output: " << outFile;
+        ofstream out(outFile.c_str(), ios::binary);
+        cfg->writeBinary(out);
+        out.close();
+        if (!out) {
+            delete cfg;
+            writeStats(record.str() + " error: write_failed", false);
+            continue;
+        }
+        record << " compression_time: " << setprecision(10) << comp.getCompressionTime() << " ";
+        cfg->printSize(record); record << " ";
+        comp.printStats(record);
+        delete cfg;
+        // printStats ends the line
+        string r = record.str(); r.erase(r.size()-1);
+        writeStats(r, true);
+    }
+}
+
+void BatchCompressor::writeStats(const string& record, bool ok) {
+    pthread_mutex_lock(&statsMutex);
+    statsFile << record << endl;
+    if (!ok) numFailed++;
+    pthread_mutex_unlock(&statsMutex);
+}
+
+// read entire file to str, if ignoreWs is true skip whitespace characters
+bool BatchCompressor::readFile(const string& path, string& str, bool ignoreWs) {
+    ifstream in(path.c_str(), ios::binary);
+    if (!in) return false;
+    in.seekg(0, ios::end);
+    long size = in.tellg();
+    in.seekg(0, ios::beg);
+    str.resize(size);
+    if (size > 0) in.read(&str[0], size);
+    if (!in) return false;
+    if (ignoreWs) {
+        int j = 0;
+        for (int i = 0; i < size; ++i) if (!isspace((unsigned char)str[i])) str[j++] = str[i];
+        str.resize(j);
+    }
+    return true;
+}
+
+string BatchCompressor::baseName(const string& path) {
+    size_t slash = path.find_last_of('/');
+    if (slash == string::npos) return path;
+    return path.substr(slash + 1);
+}
@@ -0,0 +1,69 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef BATCHCOMPRESSOR_H
+#define	BATCHCOMPRESSOR_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <pthread.h>
+
+#include "BlockingQueue.h"
+
+using namespace std;
+
+/* Compresses many files in one process on a pool of worker threads. 
+ * Files are scheduled largest first so that small files fill the time 
+ * at the end of the batch. Each worker reuses its compressor workspace 
+ * for all the files it compresses. Grammar of each file is written in binary
+ * format to the output folder as file name + ".cfg", files with the same name
+ * in different folders get a numbered suffix (name-2.cfg) so that no output 
+ * is overwritten. Statistics of each file, with the output file name, are 
+ * written as one line to batch_stats.txt in the output folder. */
+class BatchCompressor {
+public:
+    BatchCompressor(int threads, string outFolder, bool ignoreWs = false);
+    virtual ~BatchCompressor();
+    
+    bool addFiles(string path);
+    int run();
+    
+    static bool readFile(const string& path, string& str, bool ignoreWs);
+    static bool listFiles(const string& path, vector<string>& files);
+    
+private:
+    
+    int numThreads;
+    string outFolder;
+    bool ignorews;
+    
+    vector<string> files;
+    BlockingQueue<string> queue;
+    // output file of each input file, filled before the workers start
+    map<string, string> outputs;
+    
+    pthread_mutex_t statsMutex;
+    ofstream statsFile;
+    int numFailed;
+    
+    static void* workerMain(void* batch);
+    void work();
+    void writeStats(const string& record, bool ok);
+    static string baseName(const string& path);
+    void assignOutputs();
+    
+};
+
+#endif	/* BATCHCOMPRESSOR_H */
@@ -0,0 +1,105 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef BLOCKINGQUEUE_H
+#define	BLOCKINGQUEUE_H
+
+#include <deque>
+#include <pthread.h>
+
+using namespace std;
+
+/* Thread safe FIFO queue with bounded capacity. push() blocks while the queue
+ * is full and pop() blocks while it is empty. After close() no more elements
+ * can be added and pop() returns false once the queue is drained. */
+template <typename T>
+class BlockingQueue {
+public:
+    // capacity <= 0 means unbounded queue
+    BlockingQueue(int capacity = 0): cap(capacity), closed(false) {
+        pthread_mutex_init(&mutex, 0);
+        pthread_cond_init(&notEmpty, 0);
+        pthread_cond_init(&notFull, 0);
+    }
+    
+    virtual ~BlockingQueue() {
+        pthread_mutex_destroy(&mutex);
+        pthread_cond_destroy(&notEmpty);
+        pthread_cond_destroy(&notFull);
+    }
+    
+    // add element, return false if the queue is closed
+    bool push(const T& e) {
+        pthread_mutex_lock(&mutex);
+        while (!closed && cap > 0 && elements.size() >= cap) pthread_cond_wait(&notFull, &mutex);
+        bool ok = !closed;
+        if (ok) {
+            elements.push_back(e);
+            pthread_cond_signal(&notEmpty);
+        }
+        pthread_mutex_unlock(&mutex);
+        return ok;
+    }
+    
+    // add element only if there is space, return false otherwise
+    bool tryPush(const T& e) {
+        pthread_mutex_lock(&mutex);
+        bool ok = !closed && (cap <= 0 || elements.size() < cap);
+        if (ok) {
+            elements.push_back(e);
+            pthread_cond_signal(&notEmpty);
+        }
+        pthread_mutex_unlock(&mutex);
+        return ok;
+    }
+    
+    // remove first element, return false if the queue is closed and empty
+    bool pop(T& e) {
+        pthread_mutex_lock(&mutex);
+        while (!closed && elements.empty()) pthread_cond_wait(&notEmpty, &mutex);
+        bool ok = !elements.empty();
+        if (ok) {
+            e = elements.front();
+            elements.pop_front();
+            pthread_cond_signal(&notFull);
+        }
+        pthread_mutex_unlock(&mutex);
+        return ok;
+    }
+    
+    void close() {
+        pthread_mutex_lock(&mutex);
+        closed = true;
+        pthread_cond_broadcast(&notEmpty);
+        pthread_cond_broadcast(&notFull);
+        pthread_mutex_unlock(&mutex);
+    }
+    
+    int size() {
+        pthread_mutex_lock(&mutex);
+        int s = elements.size();
+        pthread_mutex_unlock(&mutex);
+        return s;
+    }
+    
+private:
+    
+    deque<T> elements;
+    int cap;
+    bool closed;
+    pthread_mutex_t mutex;
+    pthread_cond_t notEmpty, notFull;
+    
+};
+
+#endif	/* BLOCKINGQUEUE_H */
@@ -0,0 +1,75 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <iomanip>
+#include <pthread.h>
+
+#include "ChunkCompressor.h"
+#include "compress/LongestFirstSaCompressor.h"
+#include "compress/CompressorWorkspace.h"
+#include "compress/GrammarMerger.h"
+#include "util/Profiler.h"
+
+ChunkCompressor::ChunkCompressor(const char* s, int l, int size, int threads): 
+        str(s), N(l), chunkSize(size), numThreads(threads), 
+        numChunks(0), numMerged(0), compressionTime(0) {
+    if (chunkSize < 1) chunkSize = N > 0 ? N : 1;
+    if (numThreads < 1) numThreads = 1;
+}
+
+ChunkCompressor::~ChunkCompressor() { }
+
+CfGrammar* ChunkCompressor::compress() {
+    double start = getWallTime();
+    numChunks = (N + chunkSize - 1) / chunkSize;
+    chunkGrammars.assign(numChunks, (CfGrammar*)0);
+    for (int i = 0; i < numChunks; ++i) queue.push(i);
+    queue.close();
+    vector<pthread_t> threads(numThreads);
+    for (int i = 0; i < numThreads; ++i) pthread_create(&threads[i], 0, workerMain, this);
+    for (int i = 0; i < numThreads; ++i) pthread_join(threads[i], 0);
+    // merge chunk grammars in order of the chunks
+    GrammarMerger merger;
+    for (int i = 0; i < numChunks; ++i) {
+        merger.appendGrammar(chunkGrammars[i]);
+        delete chunkGrammars[i];
+    }
+    chunkGrammars.clear();
+    numMerged = merger.getNumMerged();
+    CfGrammar* grammar = merger.createGrammar();
+    compressionTime = getWallTime() - start;
+    return grammar;
+}
+
+void* ChunkCompressor::workerMain(void* compressor) {
+    ((ChunkCompressor*)compressor)->work();
+    return 0;
+}
+
+// worker loop, compress chunks from the queue until it is empty
+void ChunkCompressor::work() {
+    CompressorWorkspace workspace;
+    int chunk;
+    while (queue.pop(chunk)) {
+        int begin = chunk * chunkSize;
+        int len = min(chunkSize, N - begin);
+        LongestFirstSaCompressor comp(str + begin, len, false, false, &workspace);
+        chunkGrammars[chunk] = comp.compress();
+    }
+}
+
+void ChunkCompressor::printStats(ostream& out) {
+    out << "compression_time: " << setprecision(10) << compressionTime;
+    out << " num_chunks: " << numChunks << " chunk_size: " << chunkSize;
+    out << " num_threads: " << numThreads << " merged_rules: " << numMerged << endl;
+}
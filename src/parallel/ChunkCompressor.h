@@ -0,0 +1,56 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef CHUNKCOMPRESSOR_H
+#define	CHUNKCOMPRESSOR_H
+
+#include <iostream>
+#include <vector>
+
+#include "BlockingQueue.h"
+#include "compress/CfGrammar.h"
+
+using namespace std;
+
+/* Compresses a string split into chunks of fixed size in parallel, each chunk 
+ * is compressed by LongestFirstSaCompressor and the chunk grammars are merged 
+ * into one grammar, rules with identical expansions in different chunks 
+ * are merged by expansion fingerprint. Repeats crossing chunk boundaries 
+ * and repeats within one chunk only are not compressed across chunks, 
+ * which is the compression ratio traded for parallelism. */
+class ChunkCompressor {
+public:
+    ChunkCompressor(const char* s, int l, int chunkSize, int threads);
+    virtual ~ChunkCompressor();
+    
+    CfGrammar* compress();
+    void printStats(ostream& out);
+    
+private:
+    
+    const char* str;
+    int N, chunkSize, numThreads;
+    
+    vector<CfGrammar*> chunkGrammars;
+    BlockingQueue<int> queue; // indexes of chunks to compress
+    
+    // statistics
+    int numChunks, numMerged;
+    double compressionTime;
+    
+    static void* workerMain(void* compressor);
+    void work();
+    
+};
+
+#endif	/* CHUNKCOMPRESSOR_H */
@@ -0,0 +1,315 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "CompressionServer.h"
+#include "compress/LongestFirstSaCompressor.h"
+#include "compress/CfGrammar.h"
+#include "util/Profiler.h"
+
+const char CompressionServer::COMPRESS = 'C';
+const char CompressionServer::DECOMPRESS = 'D';
+const char CompressionServer::STATS = 'S';
+const char CompressionServer::SHUTDOWN = 'Q';
+const char CompressionServer::OK = 'K';
+const char CompressionServer::ERROR = 'E';
+const unsigned CompressionServer::MAX_PAYLOAD = 1u << 30;
+const int CompressionServer::IDLE_CHECK_MS = 500;
+
+CompressionServer::CompressionServer(const string& path, int threads, int queueSize): 
+        socketPath(path), numThreads(threads), listenFd(-1), stopping(false), 
+        connections(queueSize > 0 ? queueSize : 2 * (threads > 0 ? threads : 1)), 
+        numRequests(0), numFailed(0), numConnections(0), bytesIn(0), bytesOut(0), 
+        compressionTime(0), busyTime(0), maxQueued(0) {
+    if (numThreads < 1) numThreads = 1;
+    pthread_mutex_init(&statsMutex, 0);
+    pthread_mutex_init(&connMutex, 0);
+}
+
+CompressionServer::~CompressionServer() {
+    pthread_mutex_destroy(&statsMutex);
+    pthread_mutex_destroy(&connMutex);
+}
+
+// open Unix socket at the path, listening or connected to it, return -1 on failure
+static int openSocket(const string& path, bool listening) {
+    struct sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path)) return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int res;
+    if (listening) {
+        unlink(path.c_str());
+        res = bind(fd, (struct sockaddr*)&addr, sizeof(addr));
+        if (res == 0) res = listen(fd, SOMAXCONN);
+    }
+    else res = connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+    if (res != 0) { close(fd); return -1; }
+    return fd;
+}
+
+// create socket at the path, start workers and accept connections until 
+// shutdown request, return false if socket can not be created or accept fails
+bool CompressionServer::run() {
+    listenFd = openSocket(socketPath, true);
+    if (listenFd < 0) return false;
+    vector<pthread_t> threads(numThreads);
+    for (int i = 0; i < numThreads; ++i) pthread_create(&threads[i], 0, workerMain, this);
+    bool ok = true;
+    while (!isStopping()) {
+        int fd = accept(listenFd, 0, 0);
+        if (fd < 0) {
+            if (isStopping() || errno == EINTR || errno == ECONNABORTED) continue;
+            // out of descriptors or memory, wait for connections to close
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                usleep(100000);
+                continue;
+            }
+            ok = false;
+            stop();
+            break;
+        }
+        if (!addConnection(fd)) { // shutdown was requested meanwhile
+            close(fd);
+            continue;
+        }
+        pthread_mutex_lock(&statsMutex);
+        numConnections++;
+        maxQueued = max(maxQueued, connections.size() + 1);
+        pthread_mutex_unlock(&statsMutex);
+        // blocks while all the workers are busy and the queue is full
+        if (!connections.push(fd)) { removeConnection(fd); close(fd); }
+    }
+    connections.close();
+    for (int i = 0; i < numThreads; ++i) pthread_join(threads[i], 0);
+    close(listenFd);
+    unlink(socketPath.c_str());
+    return ok;
+}
+
+bool CompressionServer::isStopping() {
+    pthread_mutex_lock(&connMutex);
+    bool s = stopping;
+    pthread_mutex_unlock(&connMutex);
+    return s;
+}
+
+// register accepted connection, return false if the server is stopping
+bool CompressionServer::addConnection(int fd) {
+    pthread_mutex_lock(&connMutex);
+    bool ok = !stopping;
+    if (ok) openFds.insert(fd);
+    pthread_mutex_unlock(&connMutex);
+    return ok;
+}
+
+// unregister connection, must be called before the descriptor is closed
+void CompressionServer::removeConnection(int fd) {
+    pthread_mutex_lock(&connMutex);
+    openFds.erase(fd);
+    pthread_mutex_unlock(&connMutex);
+}
+
+// stop accepting and shut down reading of the open connections, so that 
+// workers waiting for requests return, responses can still be sent
+void CompressionServer::stop() {
+    pthread_mutex_lock(&connMutex);
+    stopping = true;
+    for (set<int>::iterator it = openFds.begin(); it != openFds.end(); ++it) shutdown(*it, SHUT_RD);
+    // wake up accept() in run()
+    if (listenFd >= 0) shutdown(listenFd, SHUT_RDWR);
+    pthread_mutex_unlock(&connMutex);
+}
+
+void* CompressionServer::workerMain(void* server) {
+    ((CompressionServer*)server)->work();
+    return 0;
+}
+
+// worker loop, serve connections from the queue
+void CompressionServer::work() {
+    CompressorWorkspace workspace;
+    int fd;
+    while (connections.pop(fd)) {
+        serve(fd, workspace);
+        removeConnection(fd);
+        close(fd);
+    }
+}
+
+// wait until a request arrives to the connection, return false if the 
+// connection is idle while other connections are queued or server is stopping
+bool CompressionServer::waitRequest(int fd) {
+    struct pollfd p;
+    p.fd = fd; p.events = POLLIN;
+    while (true) {
+        p.revents = 0;
+        int r = poll(&p, 1, IDLE_CHECK_MS);
+        if (r > 0) return true;
+        if (r < 0 && errno != EINTR) return false;
+        if (r == 0 && (isStopping() || connections.size() > 0)) return false;
+    }
+}
+
+// serve requests from the connection until it is closed or idle while 
+// other connections wait, return false if the connection failed
+bool CompressionServer::serve(int fd, CompressorWorkspace& workspace) {
+    char type; string payload, response;
+    while (waitRequest(fd) && receiveFrame(fd, type, payload)) {
+        double start = getWallTime();
+        bool ok = handle(type, payload, response, workspace);
+        double time = getWallTime() - start;
+        pthread_mutex_lock(&statsMutex);
+        numRequests++; 
+        if (!ok) numFailed++;
+        bytesIn += payload.size(); bytesOut += response.size();
+        busyTime += time;
+        if (type == COMPRESS && ok) compressionTime += time;
+        pthread_mutex_unlock(&statsMutex);
+        if (!sendFrame(fd, ok ? OK : ERROR, response)) return false;
+        if (type == SHUTDOWN) stop();
+    }
+    return true;
+}
+
+// process request, return false and error message in response on failure, 
+// exceptions (allocation failures) are reported to the client as errors
+bool CompressionServer::handle(char type, const string& payload, string& response, 
+                               CompressorWorkspace& workspace) {
+    try {
+        return handleRequest(type, payload, response, workspace);
+    }
+    catch (const exception& e) {
+        response = string("request failed: ") + e.what();
+    }
+    catch (...) {
+        response = "request failed";
+    }
+    return false;
+}
+
+bool CompressionServer::handleRequest(char type, const string& payload, string& response, 
+                                      CompressorWorkspace& workspace) {
+    if (type == COMPRESS) {
+        LongestFirstSaCompressor comp(payload.data(), payload.size(), false, false, &workspace);
+        CfGrammar* cfg = comp.compress();
+        ostringstream out;
+        cfg->writeBinary(out);
+        delete cfg;
+        response = out.str();
+        return true;
+    }
+    else if (type == DECOMPRESS) {
+        istringstream in(payload);
+        CfGrammar* cfg = CfGrammar::readBinary(in);
+        if (cfg == 0) { response = "malformed grammar"; return false; }
+        try {
+            response = cfg->expand();
+        }
+        catch (...) {
+            delete cfg;
+            throw;
+        }
+        delete cfg;
+        return true;
+    }
+    else if (type == STATS) { response = statsString(); return true; }
+    else if (type == SHUTDOWN) { response.clear(); return true; }
+    response = "unknown request type";
+    return false;
+}
+
+string CompressionServer::statsString() {
+    ostringstream out;
+    pthread_mutex_lock(&statsMutex);
+    out << "num_threads: " << numThreads << " connections: " << numConnections;
+    out << " queued: " << connections.size() << " max_queued: " << maxQueued << endl;
+    out << "requests: " << numRequests << " failed: " << numFailed;
+    out << " bytes_in: " << bytesIn << " bytes_out: " << bytesOut << endl;
+    out << "busy_time: " << setprecision(10) << busyTime;
+    out << " compression_time: " << compressionTime << endl;
+    pthread_mutex_unlock(&statsMutex);
+    return out.str();
+}
+
+// write all the bytes, return false on failure
+static bool writeAll(int fd, const char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        buf += n; len -= n;
+    }
+    return true;
+}
+
+// read exactly len bytes, return false on failure or end of stream
+static bool readAll(int fd, char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = recv(fd, buf, len, 0);
+        if (n <= 0) return false;
+        buf += n; len -= n;
+    }
+    return true;
+}
+
+bool CompressionServer::sendFrame(int fd, char type, const string& payload) {
+    char header[1 + sizeof(unsigned)];
+    unsigned len = payload.size();
+    header[0] = type;
+    memcpy(header + 1, &len, sizeof(len));
+    return writeAll(fd, header, sizeof(header)) && writeAll(fd, payload.data(), len);
+}
+
+// receive frame, return false on end of stream, failure or too large payload
+bool CompressionServer::receiveFrame(int fd, char& type, string& payload) {
+    char header[1 + sizeof(unsigned)];
+    if (!readAll(fd, header, sizeof(header))) return false;
+    unsigned len;
+    type = header[0];
+    memcpy(&len, header + 1, sizeof(len));
+    if (len > MAX_PAYLOAD) return false;
+    // read in blocks, memory is allocated only for the bytes that arrive
+    const unsigned blockSize = 1 << 20;
+    payload.clear();
+    for (unsigned done = 0; done < len; ) {
+        const unsigned n = min(len - done, blockSize);
+        payload.resize(done + n);
+        if (!readAll(fd, &payload[done], n)) return false;
+        done += n;
+    }
+    return true;
+}
+
+// connect to the server, send one request and receive the response,
+// return false if the server can not be reached
+bool CompressionServer::request(const string& path, char type, const string& payload, 
+                                char& status, string& response) {
+    int fd = openSocket(path, false);
+    if (fd < 0) return false;
+    bool ok = sendFrame(fd, type, payload) && receiveFrame(fd, status, response);
+    close(fd);
+    return ok;
+}
@@ -0,0 +1,92 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef COMPRESSIONSERVER_H
+#define	COMPRESSIONSERVER_H
+
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include "BlockingQueue.h"
+#include "compress/CompressorWorkspace.h"
+
+using namespace std;
+
+/* Compression server listening on a Unix domain socket. Requests and responses
+ * are frames: a type byte, payload length as 4 byte unsigned int in host order
+ * and the payload. Request types are compress (payload is the string, response 
+ * is the grammar in binary format), decompress (grammar to string), stats 
+ * (text statistics of the server) and shutdown. Response type is OK or ERROR,
+ * payload of an error response is the message. Accepted connections wait in 
+ * a bounded queue for one of the worker threads, which serves all the requests
+ * of the connection until it is closed. When the queue is full the server 
+ * stops accepting connections, so they wait in the listen backlog. Each worker 
+ * reuses its compressor workspace for all the requests it serves. A worker
+ * gives up an idle connection when other connections are queued, so idle 
+ * clients can not block the others. On shutdown request reading side of all 
+ * the open connections is shut down and the server exits. Malformed requests
+ * get an error response and do not stop the server. */
+class CompressionServer {
+public:
+    CompressionServer(const string& path, int threads, int queueSize = 0);
+    virtual ~CompressionServer();
+    
+    bool run();
+    bool serve(int fd, CompressorWorkspace& workspace);
+    
+    static bool sendFrame(int fd, char type, const string& payload);
+    static bool receiveFrame(int fd, char& type, string& payload);
+    static bool request(const string& path, char type, const string& payload, 
+                        char& status, string& response);
+    
+    static const char COMPRESS, DECOMPRESS, STATS, SHUTDOWN, OK, ERROR;
+    static const unsigned MAX_PAYLOAD;
+    // interval of checking whether an idle connection should be given up
+    static const int IDLE_CHECK_MS;
+    
+private:
+    
+    string socketPath;
+    int numThreads;
+    int listenFd;
+    
+    // open connections and the stopping flag, guarded by connMutex
+    pthread_mutex_t connMutex;
+    set<int> openFds;
+    bool stopping;
+    
+    BlockingQueue<int> connections;
+    
+    // statistics, guarded by statsMutex
+    pthread_mutex_t statsMutex;
+    long numRequests, numFailed, numConnections, bytesIn, bytesOut;
+    double compressionTime, busyTime;
+    int maxQueued;
+    
+    static void* workerMain(void* server);
+    void work();
+    bool waitRequest(int fd);
+    bool isStopping();
+    bool addConnection(int fd);
+    void removeConnection(int fd);
+    void stop();
+    bool handle(char type, const string& payload, string& response, CompressorWorkspace& workspace);
+    bool handleRequest(char type, const string& payload, string& response, CompressorWorkspace& workspace);
+    string statsString();
+    
+};
+
+#endif	/* COMPRESSIONSERVER_H */
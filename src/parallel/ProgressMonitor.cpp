@@ -0,0 +1,120 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "ProgressMonitor.h"
+#include "util/Profiler.h"
+
+typedef LongestFirstSaCompressor::Progress Progress;
+
+ProgressMonitor::ProgressMonitor(const Progress& p, double i, ostream* o, const string& file): 
+        progress(p), interval(i), out(o), statusFile(file), running(false), stopRequested(false) {
+    if (interval <= 0) interval = 1;
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&stopped, 0);
+}
+
+ProgressMonitor::~ProgressMonitor() {
+    stop();
+    pthread_mutex_destroy(&mutex);
+    pthread_cond_destroy(&stopped);
+}
+
+void ProgressMonitor::start() {
+    if (running) return;
+    startTime = lastTime = getWallTime();
+    formStart = -1; formStartPositions = 0; lastIntervals = 0;
+    stopRequested = false;
+    running = true;
+    pthread_create(&thread, 0, threadMain, this);
+}
+
+// stop the thread and write the final report
+void ProgressMonitor::stop() {
+    if (!running) return;
+    pthread_mutex_lock(&mutex);
+    stopRequested = true;
+    pthread_cond_signal(&stopped);
+    pthread_mutex_unlock(&mutex);
+    pthread_join(thread, 0);
+    running = false;
+    report();
+}
+
+void* ProgressMonitor::threadMain(void* monitor) {
+    ((ProgressMonitor*)monitor)->run();
+    return 0;
+}
+
+// report every interval seconds until stopped
+void ProgressMonitor::run() {
+    pthread_mutex_lock(&mutex);
+    while (!stopRequested) {
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        double wake = until.tv_sec + until.tv_nsec / 1e9 + interval;
+        until.tv_sec = (time_t)wake;
+        until.tv_nsec = (long)((wake - floor(wake)) * 1e9);
+        int rc = 0;
+        while (!stopRequested && rc != ETIMEDOUT) rc = pthread_cond_timedwait(&stopped, &mutex, &until);
+        if (stopRequested) break;
+        pthread_mutex_unlock(&mutex);
+        report();
+        pthread_mutex_lock(&mutex);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+void ProgressMonitor::report() {
+    const double now = getWallTime();
+    const int phase = Progress::load(progress.phase);
+    const long done = Progress::load(progress.intervalsDone);
+    const long total = Progress::load(progress.intervalsTotal);
+    const long positions = Progress::load(progress.positionsDone);
+    const long totalPositions = Progress::load(progress.positionsTotal);
+    if (phase >= Progress::FORM_RULES && formStart < 0) {
+        formStart = now; formStartPositions = positions;
+    }
+    // interval rate since the last report, eta from the rate of positions since formStart
+    const double rate = now > lastTime ? (done - lastIntervals) / (now - lastTime) : 0;
+    double eta = -1;
+    if (phase == Progress::FORM_RULES && positions > formStartPositions && now > formStart) {
+        eta = (totalPositions - positions) * (now - formStart) / (positions - formStartPositions);
+    }
+    lastIntervals = done; lastTime = now;
+    ostringstream line;
+    line << setprecision(4) << fixed;
+    line << "elapsed: " << now - startTime << " phase: " << Progress::PHASE_NAMES[phase]
+         << " lcp: " << Progress::load(progress.lcpLevel) << " max_lcp: " << Progress::load(progress.maxLcp) 
+         << " intervals: " << done << " total_intervals: " << total 
+         << " positions: " << positions << " total_positions: " << totalPositions
+         << " done: " << (totalPositions > 0 ? 100.0 * positions / totalPositions : 0) << "%"
+         << " rules: " << Progress::load(progress.rulesCreated) 
+         << " intervals_per_s: " << rate << " eta: " << eta;
+    if (statusFile.empty() == false) { // replace the status file in one step
+        const string tmp = statusFile + ".tmp";
+        {
+            ofstream f(tmp.c_str());
+            f << line.str() << endl;
+        }
+        rename(tmp.c_str(), statusFile.c_str());
+    }
+    if (out != 0) *out << line.str() << endl;
+}
@@ -0,0 +1,64 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef PROGRESSMONITOR_H
+#define	PROGRESSMONITOR_H
+
+#include <iostream>
+#include <string>
+#include <pthread.h>
+
+#include "compress/LongestFirstSaCompressor.h"
+
+using namespace std;
+
+/* Background thread that samples the progress of a compression at a fixed 
+ * interval and reports phase, lcp level, intervals done, rules, interval 
+ * rate and estimated time to the end of rule forming. The estimate assumes 
+ * that the time of rule forming is proportional to the number of interval 
+ * positions processed, which is known in advance (sum of tree depths). 
+ * Each report is written as a line to an output stream, or replaces the 
+ * contents of a status file. The compressor only stores its counters, so 
+ * monitoring does not slow it down. */
+class ProgressMonitor {
+public:
+    ProgressMonitor(const LongestFirstSaCompressor::Progress& progress, double interval, 
+                    ostream* out, const string& statusFile = "");
+    virtual ~ProgressMonitor();
+    
+    void start();
+    void stop();
+    
+private:
+    const LongestFirstSaCompressor::Progress& progress;
+    double interval;
+    ostream* out;
+    string statusFile;
+    
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t stopped;
+    bool running, stopRequested;
+    
+    double startTime, formStart; // formStart is time when rule forming was first seen
+    long formStartPositions; // positions done at formStart
+    long lastIntervals;
+    double lastTime;
+    
+    static void* threadMain(void* monitor);
+    void run();
+    void report();
+    
+};
+
+#endif	/* PROGRESSMONITOR_H */
@@ -0,0 +1,223 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include "RecordPipeline.h"
+#include "compress/LongestFirstSaCompressor.h"
+#include "util/Profiler.h"
+
+RecordPipeline::RecordPipeline(Framing f, int bytes, int threads, int queueSize): 
+        framing(f), batchBytes(bytes), numThreads(threads), activeCompressors(0), input(0), 
+        batches(queueSize), results(queueSize), inputOk(true), 
+        numRecords(0), numBatches(0), inputBytes(0), outputBytes(0), 
+        wallTime(0), readTime(0), compressTime(0), writeTime(0) {
+    if (batchBytes < 1) batchBytes = 1;
+    if (numThreads < 1) numThreads = 1;
+    pthread_mutex_init(&statsMutex, 0);
+}
+
+RecordPipeline::~RecordPipeline() {
+    pthread_mutex_destroy(&statsMutex);
+}
+
+// run the pipeline, return false if the input ends inside a length prefixed record
+bool RecordPipeline::compress(istream& in, ostream& out) {
+    double start = getWallTime();
+    input = &in;
+    // reading from a stream tied to out (cin) would flush out from the reader thread
+    in.tie(0);
+    activeCompressors = numThreads;
+    pthread_t reader;
+    vector<pthread_t> compressors(numThreads);
+    pthread_create(&reader, 0, readerMain, this);
+    for (int i = 0; i < numThreads; ++i) pthread_create(&compressors[i], 0, compressorMain, this);
+    write(out);
+    pthread_join(reader, 0);
+    for (int i = 0; i < numThreads; ++i) pthread_join(compressors[i], 0);
+    wallTime = getWallTime() - start;
+    return inputOk;
+}
+
+void* RecordPipeline::readerMain(void* pipeline) {
+    ((RecordPipeline*)pipeline)->read();
+    return 0;
+}
+
+void* RecordPipeline::compressorMain(void* pipeline) {
+    ((RecordPipeline*)pipeline)->compressBatches();
+    return 0;
+}
+
+// read input in blocks, frame records and pass batches to the compressors
+void RecordPipeline::read() {
+    const int blockSize = 1 << 20;
+    vector<char> block(blockSize);
+    string pending; // unframed bytes from previous blocks
+    Batch* batch = new Batch(); batch->seq = 0;
+    double busyStart = getWallTime();
+    while (true) {
+        input->read(&block[0], blockSize);
+        const int n = input->gcount();
+        if (n == 0) break;
+        inputBytes += n;
+        pending.append(&block[0], n);
+        // frame complete records
+        size_t pos = 0;
+        while (true) {
+            if (framing == LINES) { // newlines stay in the text
+                size_t end = pending.find('\n', pos);
+                if (end == string::npos) break;
+                batch->text.append(pending, pos, end + 1 - pos);
+                pos = end + 1;
+            }
+            else {
+                unsigned len;
+                if (pending.size() - pos < sizeof(len)) break;
+                memcpy(&len, pending.data() + pos, sizeof(len));
+                if (pending.size() - pos - sizeof(len) < len) break;
+                batch->text.append(pending, pos + sizeof(len), len);
+                batch->lengths.push_back(len);
+                pos += sizeof(len) + len;
+            }
+            numRecords++;
+            if (batch->text.size() >= (size_t)batchBytes) {
+                const long seq = batch->seq;
+                readTime += getWallTime() - busyStart;
+                batches.push(batch); // waits while the compressors are behind
+                busyStart = getWallTime();
+                batch = new Batch(); batch->seq = seq + 1;
+            }
+        }
+        pending.erase(0, pos);
+    }
+    if (pending.empty() == false) {
+        if (framing == LINES) { // last line without newline
+            batch->text.append(pending);
+            numRecords++;
+        }
+        else inputOk = false;
+    }
+    readTime += getWallTime() - busyStart;
+    if (batch->text.empty() == false || batch->lengths.empty() == false) batches.push(batch);
+    else delete batch;
+    batches.close();
+}
+
+// compressor thread, compress batches until the reader is done
+void RecordPipeline::compressBatches() {
+    CompressorWorkspace workspace;
+    Batch* batch;
+    while (batches.pop(batch)) {
+        double start = getWallTime();
+        Result* result = new Result();
+        result->seq = batch->seq;
+        ostringstream out;
+        if (framing == LENGTH_PREFIXED) writeLengths(out, batch->lengths);
+        LongestFirstSaCompressor comp(batch->text.data(), batch->text.size(), false, false, &workspace);
+        CfGrammar* cfg = comp.compress();
+        cfg->writeBinary(out);
+        delete cfg;
+        result->output = out.str();
+        delete batch;
+        double time = getWallTime() - start;
+        pthread_mutex_lock(&statsMutex);
+        compressTime += time;
+        pthread_mutex_unlock(&statsMutex);
+        results.push(result);
+    }
+    // last compressor to finish closes the results queue
+    pthread_mutex_lock(&statsMutex);
+    bool last = (--activeCompressors == 0);
+    pthread_mutex_unlock(&statsMutex);
+    if (last) results.close();
+}
+
+// write results in the order of the batches
+void RecordPipeline::write(ostream& out) {
+    map<long, Result*> waiting; // results that came before their predecessors
+    long next = 0;
+    Result* result;
+    while (results.pop(result)) {
+        waiting[result->seq] = result;
+        double start = getWallTime();
+        while (waiting.empty() == false && waiting.begin()->first == next) {
+            Result* r = waiting.begin()->second;
+            waiting.erase(waiting.begin());
+            out.write(r->output.data(), r->output.size());
+            outputBytes += r->output.size();
+            numBatches++; next++;
+            delete r;
+        }
+        out.flush();
+        writeTime += getWallTime() - start;
+    }
+}
+
+// write the number of records and record lengths of a length prefixed batch
+void RecordPipeline::writeLengths(ostream& out, const vector<unsigned>& lengths) {
+    unsigned num = lengths.size();
+    out.write((const char*)&num, sizeof(num));
+    if (num > 0) out.write((const char*)&lengths[0], num * sizeof(unsigned));
+}
+
+// decompress batches written by compress() and write the records with framing, 
+// return false if the input is malformed
+bool RecordPipeline::decompress(istream& in, ostream& out, Framing framing) {
+    while (in.peek() != EOF) {
+        vector<unsigned> lengths;
+        if (framing == LENGTH_PREFIXED) {
+            unsigned num;
+            if (!in.read((char*)&num, sizeof(num))) return false;
+            // read in blocks, a corrupt count fails at the end of the input
+            const unsigned blockSize = 1 << 16;
+            lengths.clear();
+            for (unsigned done = 0; done < num; ) {
+                const unsigned n = min(num - done, blockSize);
+                lengths.resize(done + n);
+                if (!in.read((char*)&lengths[done], n * sizeof(unsigned))) return false;
+                done += n;
+            }
+        }
+        CfGrammar* cfg = CfGrammar::readBinary(in);
+        if (cfg == 0) return false;
+        const string text = cfg->expand(0);
+        delete cfg;
+        if (framing == LINES) {
+            out << text;
+            continue;
+        }
+        size_t pos = 0;
+        for (size_t i = 0; i < lengths.size(); ++i) {
+            if (text.size() - pos < lengths[i]) return false;
+            out.write((const char*)&lengths[i], sizeof(unsigned));
+            out.write(text.data() + pos, lengths[i]);
+            pos += lengths[i];
+        }
+        if (pos != text.size()) return false;
+    }
+    return true;
+}
+
+void RecordPipeline::printStats(ostream& out) {
+    out << "wall_time: " << setprecision(10) << wallTime << " records: " << numRecords;
+    out << " batches: " << numBatches << " input_bytes: " << inputBytes;
+    out << " output_bytes: " << outputBytes << endl;
+    out << "read_time: " << readTime << " read_utilization: " << readTime / wallTime << endl;
+    out << "compress_time: " << compressTime << " compress_utilization: " 
+        << compressTime / wallTime / numThreads << endl;
+    out << "write_time: " << writeTime << " write_utilization: " << writeTime / wallTime << endl;
+}
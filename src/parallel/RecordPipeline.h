@@ -0,0 +1,88 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef RECORDPIPELINE_H
+#define	RECORDPIPELINE_H
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include "BlockingQueue.h"
+#include "compress/CfGrammar.h"
+#include "compress/CompressorWorkspace.h"
+
+using namespace std;
+
+/* Compresses a stream of records in a pipeline of three stages connected 
+ * by bounded queues: reader reads the input in large blocks and frames 
+ * records into batches, compressor threads compress the batches and writer 
+ * writes the grammars in the order of the batches. Records are newline 
+ * delimited or prefixed by 4 byte length in host order. Records of a batch 
+ * are concatenated and compressed together, so repeats spanning several 
+ * records are replaced too. For each batch the output contains the grammar 
+ * in binary format, for length prefixed records preceded by the number of 
+ * records and record lengths (unsigned, host order). Newline delimited 
+ * records are compressed with the newlines, so the input is restored exactly. 
+ * Busy time of each stage is measured to show which stage limits the rate. */
+class RecordPipeline {
+public:
+    enum Framing { LINES, LENGTH_PREFIXED };
+    
+    RecordPipeline(Framing framing, int batchBytes, int threads, int queueSize = 2);
+    virtual ~RecordPipeline();
+    
+    bool compress(istream& in, ostream& out);
+    void printStats(ostream& out);
+    
+    static bool decompress(istream& in, ostream& out, Framing framing);
+    
+private:
+    
+    struct Batch {
+        long seq;
+        string text; // concatenated records, with newlines for LINES
+        vector<unsigned> lengths; // for LENGTH_PREFIXED
+    };
+    
+    struct Result {
+        long seq;
+        string output; // record lengths and grammar
+    };
+    
+    Framing framing;
+    int batchBytes, numThreads;
+    int activeCompressors; // compressor threads still running, guarded by statsMutex
+    
+    istream* input;
+    BlockingQueue<Batch*> batches;
+    BlockingQueue<Result*> results;
+    bool inputOk;
+    
+    // statistics, busy times of the compressor threads guarded by statsMutex
+    pthread_mutex_t statsMutex;
+    long numRecords, numBatches, inputBytes, outputBytes;
+    double wallTime, readTime, compressTime, writeTime;
+    
+    static void* readerMain(void* pipeline);
+    static void* compressorMain(void* pipeline);
+    void read();
+    void compressBatches();
+    void write(ostream& out);
+    static void writeLengths(ostream& out, const vector<unsigned>& lengths);
+    
+};
+
+#endif	/* RECORDPIPELINE_H */
@@ -15,9 +15,11 @@
 
 void  LcpTree::freeMemory() { free(nodes); }
 
-LcpTree LcpTreeCreator::createLcpTree(TIndex* lcp, TIndex N) {
+// create lcp interval tree, if buffer of size N is given the nodes 
+// are stored in it, otherwise the nodes are allocated and must be freed
+LcpTree LcpTreeCreator::createLcpTree(TIndex* lcp, TIndex N, LcpTreeNode* buffer) {
     // init to largest possible size
-    LcpTreeNode *lcpTree = (LcpTreeNode *)malloc(N * sizeof(LcpTreeNode));
+    LcpTreeNode *lcpTree = buffer ? buffer : (LcpTreeNode *)malloc(N * sizeof(LcpTreeNode));
     // start size is 1 to include the base interval at the beginning
     TIndex lcpTreeSize = 1;
     lcpTree[0].lcp = lcpTree[0].parent = 0;    
@@ -63,7 +65,7 @@ LcpTree LcpTreeCreator::createLcpTree(TIndex* lcp, TIndex N) {
     }
     assert(lcpTreeSize <= N);
     // resize lcpTree array to actual number of nodes
-    lcpTree = (LcpTreeNode *)realloc(lcpTree, lcpTreeSize * sizeof(LcpTreeNode));    
+    if (buffer == 0) lcpTree = (LcpTreeNode *)realloc(lcpTree, lcpTreeSize * sizeof(LcpTreeNode));    
         
     LcpTree tree;
     tree.nodes = lcpTree;
@@ -47,7 +47,7 @@ class LcpTreeCreator {
 public:    
 
     LcpTreeCreator();           
-    static LcpTree createLcpTree(TIndex* lcp, TIndex N);
+    static LcpTree createLcpTree(TIndex* lcp, TIndex N, LcpTreeNode* buffer = 0);
     static void printIntervalTree(LcpTree t);
     static LcpTreeStats getStats(LcpTree t);
       
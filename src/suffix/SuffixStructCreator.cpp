@@ -23,6 +23,22 @@ SuffixStructCreator::SuffixStructCreator(const TChar* s, int l) {
     lpf = 0;
     lpfPos = 0;
     N = l;
+    saBuffer = isaBuffer = lcpBuffer = 0;
+    auxBuffer = 0;
+    useSeparator = false;
+}
+
+// lcp values will not include the separator char, so any two suffixes have 
+// lcp as if each occurrence of the separator was a distinct unique char 
+void SuffixStructCreator::setSeparator(TChar sep) {
+    useSeparator = true;
+    separator = sep;
+}
+
+// use caller supplied buffers for suffix, inverse suffix and lcp arrays, 
+// and for the auxiliary array used in suffix array construction
+void SuffixStructCreator::setBuffers(TIndex* sa, TIndex* isa, TIndex* lcpBuff, int* auxBuff) {
+    saBuffer = sa; isaBuffer = isa; lcpBuffer = lcpBuff; auxBuffer = auxBuff;
 }
 
 
@@ -43,7 +59,7 @@ SuffixStructCreator::TIndex* SuffixStructCreator::createSuffixArray() {
     // convert chars to aux array to prepare for SA_IS method, 
     // ordering is preserved, but chars are shifted to avoid chars <= 0    
     int delta = (minCh <= 0) ? 1 - minCh : 0;
-    int *aux = new int[N+1]; int max = INT_MIN;
+    int *aux = auxBuffer ? auxBuffer : new int[N+1]; int max = INT_MIN;
     for (int i = 0; i < N; ++i) {
         aux[i] = str[i] + delta;
         if (aux[i] > max) max = aux[i];
@@ -55,9 +71,9 @@ SuffixStructCreator::TIndex* SuffixStructCreator::createSuffixArray() {
     // TODO, warning: SA_IS is indexing with TChar type, which is unsafe
     // if this is char, to be safe char string should be converted
     // to string of unsigned integers, keeping the ordering
-    suffArray = new TIndex[N+1];
+    suffArray = saBuffer ? saBuffer : new TIndex[N+1];
     SA_IS<int, TIndex>(aux, suffArray, N+1, max);    
-    delete [] aux;
+    if (aux != auxBuffer) delete [] aux;
     // last suffix (sentinel char) must be lexicographically smallest
     assert(suffArray[0] == N);
     // remove sentinel char
@@ -73,20 +89,24 @@ void SuffixStructCreator::printSuffixes() {
     }
 }
 
-void SuffixStructCreator::deleteSuffixArray() { delete [] suffArray; }
+void SuffixStructCreator::deleteSuffixArray() { 
+    if (suffArray != saBuffer) delete [] suffArray; 
+}
 
 /* Create inverse suffix array. requires: suffix array */
 SuffixStructCreator::TIndex* SuffixStructCreator::createInverseSA() {
     if (inverseSA != 0) return inverseSA;
 
-    inverseSA = new TIndex[N];
+    inverseSA = isaBuffer ? isaBuffer : new TIndex[N];
     for (TIndex i = 0; i < N; ++i)
         inverseSA[suffArray[i]] = i;
 
     return inverseSA;
 }
 
-void SuffixStructCreator::deleteInverseSA() { delete [] inverseSA; }
+void SuffixStructCreator::deleteInverseSA() { 
+    if (inverseSA != isaBuffer) delete [] inverseSA; 
+}
 
 SuffixStructCreator::TIndex* SuffixStructCreator::createLCPBruteForce() {
     lcp = new TIndex[N+1];    
@@ -104,14 +124,15 @@ SuffixStructCreator::TIndex* SuffixStructCreator::createLCPBruteForce() {
 SuffixStructCreator::TIndex* SuffixStructCreator::createLCPArray() {
     if (lcp != 0) return lcp;
     
-    lcp = new TIndex[N+1];    
+    lcp = lcpBuffer ? lcpBuffer : new TIndex[N+1];    
 
     TIndex l = 0, sai;
     for (TIndex i = 0 ; i < N ; ++i) {
         sai = inverseSA[i];
         if (sai > 0) {
             TIndex k = suffArray[sai-1];
-            while ( i+l < N && k+l < N && str[i+l] == str[k+l] ) l++;
+            while ( i+l < N && k+l < N && str[i+l] == str[k+l] && 
+                    !(useSeparator && str[i+l] == separator) ) l++;
         }
         else {
             l = 0;
@@ -124,7 +145,9 @@ SuffixStructCreator::TIndex* SuffixStructCreator::createLCPArray() {
     return lcp;
 }
  
-void SuffixStructCreator::deleteLCPArray() { delete [] lcp; }
+void SuffixStructCreator::deleteLCPArray() { 
+    if (lcp != lcpBuffer) delete [] lcp; 
+}
 
 /** Given indexes of two suffixes in the node array, calculate their
  * longest common prefix (non-overlapping). */
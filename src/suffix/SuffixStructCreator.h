@@ -38,7 +38,9 @@ using namespace std;
  * lpf (longest previous factor) array, and lpfPos (lpf position).
  * Usage: initialize with string, call create methods to create the target array(s)
  * and all array(s) needed to construct it. 
- * Then call delete methods to delete arrays no longer neccessary.  */
+ * Then call delete methods to delete arrays no longer neccessary. 
+ * Suffix, inverse suffix and lcp arrays can be created in buffers supplied 
+ * by the caller, these are not deleted by delete methods. */
 class SuffixStructCreator {
     
 public:
@@ -47,6 +49,9 @@ public:
     
     SuffixStructCreator(const TChar *str, int l);
     
+    void setBuffers(TIndex* sa, TIndex* isa, TIndex* lcpBuff, int* auxBuff);
+    void setSeparator(TChar sep);
+    
     TIndex* createSAwithSort();
     TIndex* createSuffixArray();
     void deleteSuffixArray();
@@ -79,6 +84,14 @@ private:
     TIndex* lcp;
     TIndex* lpf;
     TIndex* lpfPos;    
+    
+    // if true, common prefixes in the lcp array end before the separator
+    bool useSeparator;
+    TChar separator;
+    
+    // caller supplied buffers, sa, lcp and aux must hold N+1 elements
+    TIndex *saBuffer, *isaBuffer, *lcpBuffer;
+    int* auxBuffer;
 
     /* Position in the suffix array and position where
      * (currently) best lpf for that position starts. */
@@ -0,0 +1,306 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+#include "Benchmark.h"
+#include "util/Profiler.h"
+#include "compress/LongestFirstSaCompressor.h"
+
+const char* const Benchmark::CORPORA[] = 
+    { "random", "fibonacci", "thue-morse", "dna", "runs", "text" };
+const int Benchmark::NUM_CORPORA = 6;
+
+const char* const Benchmark::PHASES[] = 
+    { "suffix_array", "inverse_sa", "lcp_array", "lcp_tree", "schedule", "form_rules", 
+      "create_grammar", "compress", "output", "decompress" };
+const int Benchmark::NUM_PHASES = 10;
+
+Benchmark::Benchmark(int reps, int w): repetitions(reps), warmup(w) {
+    if (repetitions < 1) repetitions = 1;
+    if (warmup < 0) warmup = 0;
+}
+
+// add generated corpus of given size
+void Benchmark::addCorpus(const string& corpus, int size) {
+    Case c;
+    ostringstream name; name << corpus << "-" << size;
+    c.name = name.str(); c.corpus = corpus;
+    c.text = generate(corpus, size);
+    cases.push_back(c);
+}
+
+void Benchmark::addFile(const string& name, const string& text) {
+    Case c;
+    c.name = name; c.corpus = "file";
+    c.text = text;
+    cases.push_back(c);
+}
+
+bool Benchmark::isCorpus(const string& corpus) {
+    for (int i = 0; i < NUM_CORPORA; ++i) if (corpus == CORPORA[i]) return true;
+    return false;
+}
+
+// pseudo random numbers independent of the platform, so corpora are the same everywhere
+static unsigned nextRandom(unsigned& state) {
+    state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+    return state;
+}
+
+// generate a corpus of given size, empty string for unknown corpus
+string Benchmark::generate(const string& corpus, int size, unsigned seed) {
+    string s; s.reserve(size);
+    unsigned state = seed * 2654435761u + 1;
+    if (corpus == "random") { // printable chars
+        while ((int)s.size() < size) s += (char)(' ' + nextRandom(state) % 95);
+    }
+    else if (corpus == "fibonacci") { // S(n) = S(n-1) S(n-2), highly repetitive
+        string prev = "b", cur = "a";
+        while ((int)cur.size() < size) { string next = cur + prev; prev = cur; cur = next; }
+        s = cur.substr(0, size);
+    }
+    else if (corpus == "thue-morse") { // i-th char is the parity of ones in i
+        for (int i = 0; i < size; ++i) s += __builtin_popcount(i) % 2 ? 'b' : 'a';
+    }
+    else if (corpus == "dna") { // random bases and mutated copies of earlier segments
+        const char bases[] = "ACGT";
+        while ((int)s.size() < size) {
+            if (s.size() > 1000 && nextRandom(state) % 4 == 0) {
+                int len = 100 + nextRandom(state) % 900;
+                int from = nextRandom(state) % (s.size() - len);
+                for (int i = 0; i < len; ++i) {
+                    if (nextRandom(state) % 100 == 0) s += bases[nextRandom(state) % 4];
+                    else s += s[from + i];
+                }
+            }
+            else for (int i = 0; i < 100; ++i) s += bases[nextRandom(state) % 4];
+        }
+        s.resize(size);
+    }
+    else if (corpus == "runs") { // runs of random letters
+        while ((int)s.size() < size) {
+            // letter is drawn before the length, evaluation order of arguments is unspecified
+            char letter = 'a' + nextRandom(state) % 26;
+            int length = 1 + nextRandom(state) % 64;
+            s.append(length, letter);
+        }
+        s.resize(size);
+    }
+    else if (corpus == "text") { // words of a random vocabulary with Zipf distribution
+        const int vocabulary = 2000;
+        vector<string> words(vocabulary);
+        vector<double> cumulative(vocabulary);
+        double sum = 0;
+        for (int w = 0; w < vocabulary; ++w) {
+            int len = 2 + nextRandom(state) % 8;
+            for (int i = 0; i < len; ++i) words[w] += 'a' + nextRandom(state) % 26;
+            sum += 1.0 / (w + 1);
+            cumulative[w] = sum;
+        }
+        int wordsInSentence = 0;
+        while ((int)s.size() < size) {
+            double r = (nextRandom(state) / 4294967296.0) * sum;
+            int w = lower_bound(cumulative.begin(), cumulative.end(), r) - cumulative.begin();
+            if (w == vocabulary) w = vocabulary - 1;
+            s += words[w];
+            if (++wordsInSentence == 12) { s += ".\n"; wordsInSentence = 0; }
+            else s += ' ';
+        }
+        s.resize(size);
+    }
+    return s;
+}
+
+// run all cases, warmup runs first
+void Benchmark::run(ostream& log) {
+    for (int i = 0; i < cases.size(); ++i) {
+        Case& c = cases[i];
+        for (int r = 0; r < warmup; ++r) runCase(c, false);
+        for (int r = 0; r < repetitions; ++r) runCase(c, true);
+        const vector<double>& total = c.times["compress"];
+        log << c.name << ": size " << c.text.size() << " grammar_size " << c.grammarSize 
+            << " compress_median " << setprecision(6) << percentile(total, 0.5) 
+            << " decompress_median " << percentile(c.times["decompress"], 0.5) << endl;
+    }
+}
+
+// compress, write and decompress the text of a case, record phase times if measure
+void Benchmark::runCase(Case& c, bool measure) {
+    LongestFirstSaCompressor comp(c.text.data(), c.text.size());
+    double start = getWallTime();
+    CfGrammar* cfg = comp.compress();
+    double compressTime = getWallTime() - start;
+    ostringstream out;
+    start = getWallTime();
+    cfg->writeBinary(out);
+    double outputTime = getWallTime() - start;
+    c.grammarSize = cfg->getSize();
+    c.memoryPeak = comp.getMemoryUsage().getPeak();
+    delete cfg;
+    const string binary = out.str();
+    c.outputBytes = binary.size();
+    istringstream in(binary);
+    start = getWallTime();
+    CfGrammar* decoded = CfGrammar::readBinary(in);
+    string expanded = decoded->expand(0);
+    double decompressTime = getWallTime() - start;
+    delete decoded;
+    if (expanded != c.text) cerr << c.name << ": decompressed string differs" << endl;
+    if (!measure) return;
+    const LongestFirstSaCompressor::PhaseTimes& t = comp.getPhaseTimes();
+    c.times["suffix_array"].push_back(t.suffixArray);
+    c.times["inverse_sa"].push_back(t.inverseSA);
+    c.times["lcp_array"].push_back(t.lcpArray);
+    c.times["lcp_tree"].push_back(t.lcpTree);
+    c.times["schedule"].push_back(t.schedule);
+    c.times["form_rules"].push_back(t.formRules);
+    c.times["create_grammar"].push_back(t.createGrammar);
+    c.times["compress"].push_back(compressTime);
+    c.times["output"].push_back(outputTime);
+    c.times["decompress"].push_back(decompressTime);
+}
+
+// p-th percentile, interpolated between the closest ranks
+double Benchmark::percentile(vector<double> times, double p) {
+    if (times.empty()) return 0;
+    sort(times.begin(), times.end());
+    double rank = p * (times.size() - 1);
+    int low = (int)floor(rank);
+    if (low + 1 >= times.size()) return times.back();
+    return times[low] + (rank - low) * (times[low + 1] - times[low]);
+}
+
+void Benchmark::writeJson(ostream& out) {
+    out << "{\"repetitions\": " << repetitions << ", \"warmup\": " << warmup << ", \"cases\": [" << endl;
+    out << setprecision(6);
+    for (int i = 0; i < cases.size(); ++i) {
+        Case& c = cases[i];
+        out << "{\"name\": \"" << escapeJson(c.name) << "\", \"corpus\": \"" << escapeJson(c.corpus) 
+            << "\", \"size\": " << c.text.size() << ", \"grammar_size\": " << c.grammarSize 
+            << ", \"output_bytes\": " << c.outputBytes << ", \"memory_peak\": " << c.memoryPeak 
+            << ", \"bytes_per_char\": " << (c.text.empty() ? 0 : (double)c.memoryPeak / c.text.size())
+            << ", \"phases\": {";
+        for (int p = 0; p < NUM_PHASES; ++p) {
+            const vector<double>& times = c.times[PHASES[p]];
+            out << (p > 0 ? ", " : "") << "\"" << PHASES[p] << "\": {\"median\": " 
+                << percentile(times, 0.5) << ", \"p10\": " << percentile(times, 0.1) 
+                << ", \"p90\": " << percentile(times, 0.9) << ", \"min\": " << percentile(times, 0)
+                << ", \"max\": " << percentile(times, 1) << "}";
+        }
+        out << "}}" << (i + 1 < cases.size() ? "," : "") << endl;
+    }
+    out << "]}" << endl;
+}
+
+// string with quotes, backslashes and control chars escaped for JSON
+string Benchmark::escapeJson(const string& s) {
+    ostringstream out;
+    for (int i = 0; i < s.size(); ++i) {
+        const unsigned char c = s[i];
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (c < 0x20) out << "\\u" << hex << setw(4) << setfill('0') << (int)c << dec;
+        else out << c;
+    }
+    return out.str();
+}
+
+// read JSON string whose contents start at pos, up to the closing quote,
+// return false if the string is not terminated or has an invalid escape
+bool Benchmark::readJsonString(const string& line, size_t pos, string& value) {
+    value.clear();
+    for (size_t i = pos; i < line.size(); ++i) {
+        if (line[i] == '"') return true;
+        if (line[i] != '\\') { value += line[i]; continue; }
+        if (++i == line.size()) return false;
+        switch (line[i]) {
+            case '"': case '\\': case '/': value += line[i]; break;
+            case 'b': value += '\b'; break;
+            case 'f': value += '\f'; break;
+            case 'n': value += '\n'; break;
+            case 'r': value += '\r'; break;
+            case 't': value += '\t'; break;
+            case 'u': { // only chars of one byte are written by escapeJson
+                if (i + 4 >= line.size()) return false;
+                char* end;
+                string digits = line.substr(i + 1, 4);
+                long c = strtol(digits.c_str(), &end, 16);
+                if (end != digits.c_str() + 4 || c > 0xff) return false;
+                value += (char)c;
+                i += 4;
+                break;
+            }
+            default: return false;
+        }
+    }
+    return false;
+}
+
+// find "key": followed by a number in a line of JSON
+bool Benchmark::findNumber(const string& line, const string& key, double& value) {
+    size_t pos = line.find(key);
+    if (pos == string::npos) return false;
+    const char* begin = line.c_str() + pos + key.size();
+    char* end;
+    value = strtod(begin, &end);
+    return end != begin;
+}
+
+// compare phase medians and grammar sizes with a baseline written by writeJson, 
+// a phase regressed if its median grew by more than tolerance (fraction) and 
+// by more than 1 ms, return the number of regressions
+int Benchmark::compare(istream& baseline, double tolerance, ostream& out) {
+    map<string, string> baseLines; // case name -> line
+    string line;
+    while (getline(baseline, line)) {
+        const string key = "{\"name\": \"";
+        if (line.compare(0, key.size(), key) != 0) continue;
+        string name;
+        if (readJsonString(line, key.size(), name)) baseLines[name] = line;
+    }
+    int regressions = 0;
+    out << setprecision(4);
+    for (int i = 0; i < cases.size(); ++i) {
+        Case& c = cases[i];
+        if (baseLines.count(c.name) == 0) {
+            out << c.name << ": not in baseline" << endl;
+            continue;
+        }
+        double baseSize;
+        if (findNumber(baseLines[c.name], "\"grammar_size\": ", baseSize) && baseSize != c.grammarSize) {
+            out << c.name << " grammar_size: " << (c.grammarSize > baseSize ? "regression " : "improvement ") 
+                << (long)baseSize << " -> " << c.grammarSize << endl;
+            if (c.grammarSize > baseSize) regressions++;
+        }
+        for (int p = 0; p < NUM_PHASES; ++p) {
+            double base;
+            if (!findNumber(baseLines[c.name], string("\"") + PHASES[p] + "\": {\"median\": ", base)) continue;
+            double current = percentile(c.times[PHASES[p]], 0.5);
+            if (current > base * (1 + tolerance) && current - base > 1e-3) {
+                out << c.name << " " << PHASES[p] << ": regression " << base << " -> " << current 
+                    << " (+" << (current / base - 1) * 100 << "%)" << endl;
+                regressions++;
+            }
+            else if (current < base * (1 - tolerance) && base - current > 1e-3) {
+                out << c.name << " " << PHASES[p] << ": improvement " << base << " -> " << current 
+                    << " (-" << (1 - current / base) * 100 << "%)" << endl;
+            }
+        }
+    }
+    out << "regressions: " << regressions << endl;
+    return regressions;
+}
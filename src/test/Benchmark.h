@@ -0,0 +1,72 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef BENCHMARK_H
+#define	BENCHMARK_H
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* Times the phases of compression and decompression: suffix array, inverse 
+ * suffix array, lcp array, lcp interval tree, descending lcp schedule, 
+ * rule forming, grammar creation, output in binary format and decompression 
+ * (reading and expanding the grammar). Each case is a generated corpus of a 
+ * given size or a file. Cases are run warmup times without measuring, then 
+ * repetitions times, and median, 10th and 90th percentile, minimum and 
+ * maximum time of each phase, with peak memory of the compressor, are 
+ * written as JSON, one case per line. 
+ * Results can be compared to a saved JSON file to find regressions. */
+class Benchmark {
+public:
+    Benchmark(int repetitions = 5, int warmup = 1);
+    
+    void addCorpus(const string& corpus, int size);
+    void addFile(const string& name, const string& text);
+    void run(ostream& log);
+    void writeJson(ostream& out);
+    int compare(istream& baseline, double tolerance, ostream& out);
+    
+    static bool isCorpus(const string& corpus);
+    static string generate(const string& corpus, int size, unsigned seed = 1);
+    
+    static const char* const CORPORA[];
+    static const int NUM_CORPORA;
+    static const char* const PHASES[];
+    static const int NUM_PHASES;
+    
+private:
+    
+    struct Case {
+        string name, corpus;
+        string text;
+        int grammarSize, outputBytes;
+        long memoryPeak; // bytes of the compressor structures
+        map<string, vector<double> > times; // phase -> times of repetitions
+    };
+    
+    int repetitions, warmup;
+    vector<Case> cases;
+    
+    void runCase(Case& c, bool measure);
+    static double percentile(vector<double> times, double p);
+    static bool findNumber(const string& line, const string& key, double& value);
+    static string escapeJson(const string& s);
+    static bool readJsonString(const string& line, size_t pos, string& value);
+    
+};
+
+#endif	/* BENCHMARK_H */
@@ -0,0 +1,116 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <cmath>
+#include <iomanip>
+
+#include "ScalingExperiment.h"
+#include "util/Profiler.h"
+#include "compress/LongestFirstSaCompressor.h"
+#include "compress/CompressorWorkspace.h"
+
+const char* const ScalingExperiment::COLUMNS[] = 
+    { "suffix_array", "inverse_sa", "lcp_array", "lcp_tree", "schedule", "form_rules", 
+      "create_grammar", "compress", "interval_tree_size", "sum_of_tree_depths", "alpha", 
+      "num_rules", "grammar_size", "memory_peak" };
+const int ScalingExperiment::NUM_COLUMNS = 14;
+
+// columns for which the exponent is fitted
+const char* const ScalingExperiment::FITTED[] = 
+    { "compress", "suffix_array", "form_rules", "sum_of_tree_depths", "grammar_size", "memory_peak" };
+const int ScalingExperiment::NUM_FITTED = 6;
+
+ScalingExperiment::ScalingExperiment(const string& t, int p): text(t), parts(p > 0 ? p : 1) { }
+
+// compress the prefixes, shortest first
+void ScalingExperiment::run(ostream& log) {
+    CompressorWorkspace workspace;
+    workspace.reserve(text.size());
+    prefixes.clear();
+    const int partSize = text.size() / parts;
+    for (int i = 1; i <= parts; ++i) {
+        Prefix p;
+        p.size = i < parts ? partSize * i : text.size();
+        if (p.size == 0) continue;
+        LongestFirstSaCompressor comp(text.data(), p.size, false, false, &workspace);
+        double start = getWallTime();
+        CfGrammar* cfg = comp.compress();
+        double compressTime = getWallTime() - start;
+        const LongestFirstSaCompressor::PhaseTimes& t = comp.getPhaseTimes();
+        const LcpTreeStats& stats = comp.getTreeStats();
+        double values[] = { t.suffixArray, t.inverseSA, t.lcpArray, t.lcpTree, t.schedule, 
+            t.formRules, t.createGrammar, compressTime, (double)stats.size, (double)stats.p, 
+            stats.p / (double)p.size, (double)cfg->getNumRules(), (double)cfg->getSize(), 
+            (double)comp.getMemoryUsage().getPeak() };
+        p.values.assign(values, values + NUM_COLUMNS);
+        delete cfg;
+        prefixes.push_back(p);
+        log << "prefix " << i << "/" << parts << ": size " << p.size << " compress " 
+            << setprecision(6) << compressTime << " alpha " << values[10] 
+            << " grammar_size " << values[12] << endl;
+    }
+}
+
+int ScalingExperiment::columnIndex(const string& column) {
+    for (int c = 0; c < NUM_COLUMNS; ++c) if (column == COLUMNS[c]) return c;
+    return -1;
+}
+
+// slope of the least squares line through (log size, log value), 
+// prefixes with zero value (time below clock resolution) are left out
+double ScalingExperiment::fitExponent(const string& column) {
+    const int c = columnIndex(column);
+    double sx = 0, sy = 0, sxx = 0, sxy = 0; int n = 0;
+    for (int i = 0; c >= 0 && i < prefixes.size(); ++i) {
+        if (prefixes[i].values[c] <= 0) continue;
+        double x = log((double)prefixes[i].size), y = log(prefixes[i].values[c]);
+        sx += x; sy += y; sxx += x * x; sxy += x * y; n++;
+    }
+    if (n < 2 || n * sxx - sx * sx <= 0) return 0;
+    return (n * sxy - sx * sy) / (n * sxx - sx * sx);
+}
+
+void ScalingExperiment::writeCsv(ostream& out) {
+    out << "size";
+    for (int c = 0; c < NUM_COLUMNS; ++c) out << "," << COLUMNS[c];
+    out << endl << setprecision(10);
+    for (int i = 0; i < prefixes.size(); ++i) {
+        out << prefixes[i].size;
+        for (int c = 0; c < NUM_COLUMNS; ++c) out << "," << prefixes[i].values[c];
+        out << endl;
+    }
+}
+
+void ScalingExperiment::writeJson(ostream& out) {
+    out << setprecision(10) << "{\"parts\": " << parts << ", \"prefixes\": [" << endl;
+    for (int i = 0; i < prefixes.size(); ++i) {
+        out << "{\"size\": " << prefixes[i].size;
+        for (int c = 0; c < NUM_COLUMNS; ++c) out << ", \"" << COLUMNS[c] << "\": " << prefixes[i].values[c];
+        out << "}" << (i + 1 < prefixes.size() ? "," : "") << endl;
+    }
+    out << "], \"exponents\": {";
+    for (int f = 0; f < NUM_FITTED; ++f) 
+        out << (f > 0 ? ", " : "") << "\"" << FITTED[f] << "\": " << fitExponent(FITTED[f]);
+    out << "}}" << endl;
+}
+
+// print fitted exponents, one per line
+void ScalingExperiment::printFit(ostream& out) {
+    out << setprecision(4);
+    for (int f = 0; f < NUM_FITTED; ++f) {
+        double e = fitExponent(FITTED[f]);
+        out << FITTED[f] << "_exponent: " << e;
+        if (e > 1.1) out << " superlinear";
+        out << endl;
+    }
+}
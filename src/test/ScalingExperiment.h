@@ -0,0 +1,64 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef SCALINGEXPERIMENT_H
+#define	SCALINGEXPERIMENT_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* Measures how compression scales with string length by compressing 
+ * prefixes of 1/N, 2/N, ... N/N of a text in one process, with one 
+ * workspace sized for the whole text so that buffers are allocated once. 
+ * For each prefix the time of each phase, lcp interval tree size, sum of 
+ * tree depths (alpha is the sum divided by the length), number of rules, 
+ * grammar size and peak memory are recorded and written as CSV or JSON. 
+ * Exponent b of c * length^b is fitted by least squares on log-log scale 
+ * for the times, the sum of tree depths, grammar size and memory, an 
+ * exponent noticeably above 1 means superlinear behavior on the text. */
+class ScalingExperiment {
+public:
+    ScalingExperiment(const string& text, int parts);
+    
+    void run(ostream& log);
+    void writeCsv(ostream& out);
+    void writeJson(ostream& out);
+    void printFit(ostream& out);
+    
+    double fitExponent(const string& column);
+    
+    static const char* const COLUMNS[];
+    static const int NUM_COLUMNS;
+    
+private:
+    
+    // values of the columns for one prefix
+    struct Prefix {
+        int size;
+        vector<double> values;
+    };
+    
+    const string& text;
+    int parts;
+    vector<Prefix> prefixes;
+    
+    int columnIndex(const string& column);
+    static const char* const FITTED[];
+    static const int NUM_FITTED;
+    
+};
+
+#endif	/* SCALINGEXPERIMENT_H */
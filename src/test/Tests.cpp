@@ -48,6 +48,192 @@ void Tests::runTests() {
         string exp = g->expand();
         if (exp == str) cout << " expansion match";
         else { cout << " !expansion mismatch"; emiss = true; }
+        // extract all substrings by random access and compare
+        bool amiss = !checkAccess(g, str);
+        if (amiss) cout << " !access mismatch";
+        else cout << " access match";
+        bool smiss = !checkSearch(g, str);
+        if (smiss) cout << " !search mismatch";
+        else cout << " search match";
+        // inline all the rules that do not save space
+        RuleInliner inliner;
+        CfGrammar* inlined = inliner.inlineRules(g);
+        bool imiss = (inlined->expand() != str || inlined->getSize() > g->getSize());
+        if (imiss) cout << " !inline mismatch";
+        else cout << " inline match";
+        delete inlined;
+        // balanced grammar must be AVL grammar
+        GrammarBalancer balancer;
+        CfGrammar* balanced = balancer.balance(g);
+        double maxHeight = 1.45 * log2(str.size() + 2) + 1;
+        bool bmiss = (balanced->expand() != str || 
+                      GrammarBalancer::grammarHeight(balanced) > maxHeight);
+        if (bmiss) cout << " !balance mismatch";
+        else cout << " balance match";
+        delete balanced;
+        // renumbering must not change the expansion
+        g->renumberByFirstUse();
+        if (g->expand() != str) cout << " !renumber mismatch";
+        else cout << " renumber match";
+        // compress with workspace shared by all the tests
+        LongestFirstSaCompressor wsCompressor(s, strlen(s), false, false, &workspace);
+        CfGrammar* wsg = wsCompressor.compress();
+        if (wsg->toString() != result) cout << " !workspace mismatch";
+        else cout << " workspace match";
+        delete wsg;
+        // compress in small chunks on two threads and merge
+        ChunkCompressor chunkCompressor(s, strlen(s), 5, 2);
+        CfGrammar* cg = chunkCompressor.compress();
+        if (cg->expand() != str) cout << " !chunk mismatch";
+        else cout << " chunk match";
+        delete cg;
+        // compress the string, its halves and an empty document as a document set
+        vector<string> docs;
+        docs.push_back(str); docs.push_back(str.substr(0, str.size()/2)); 
+        docs.push_back(""); docs.push_back(str.substr(str.size()/2));
+        DocumentSetCompressor docCompressor(docs);
+        CfGrammar* dg = docCompressor.compress();
+        bool dmiss = false;
+        for (int d = 0; d < docs.size(); ++d) if (dg->expand(d+1) != docs[d]) dmiss = true;
+        if (dmiss) cout << " !docs mismatch";
+        else cout << " docs match";
+        delete dg;
+        // compress in windows of 4 chars with 3 chars of context and a small 
+        // rule table, so that the rules are both reused and cleared
+        StreamCompressor streamCompressor(4, 3, 4);
+        istringstream streamIn(str);
+        ostringstream streamOut, streamExp;
+        streamCompressor.compress(streamIn, streamOut);
+        istringstream streamCompressed(streamOut.str());
+        // the string repeated in windows without context shifted against the 
+        // repeats, so that they are matched against rules of earlier windows
+        string repeated = str + str + str + str;
+        StreamCompressor seedCompressor(str.size() + 3, 0);
+        istringstream seedIn(repeated);
+        ostringstream seedOut, seedExp;
+        seedCompressor.compress(seedIn, seedOut);
+        istringstream seedCompressed(seedOut.str());
+        if (!StreamCompressor::decompress(streamCompressed, streamExp) || streamExp.str() != str ||
+            !StreamCompressor::decompress(seedCompressed, seedExp) || seedExp.str() != repeated)
+            cout << " !stream mismatch";
+        else cout << " stream match";
+        // append second half of the string to the grammar of the first half
+        const int half = str.size() / 2;
+        LongestFirstSaCompressor headCompressor(s, half);
+        CfGrammar* hg = headCompressor.compress();
+        GrammarAppender appender(hg, 32, 2);
+        CfGrammar* ag = appender.append(str.substr(half));
+        if (ag->expand() != str) cout << " !append mismatch";
+        else cout << " append match";
+        delete ag; delete hg;
+        // compress the string against its rotation, expand after binary round trip
+        string rotated = str.substr(half) + str.substr(0, half);
+        DeltaCompressor deltaCompressor(rotated, str);
+        CfGrammar* deltag = deltaCompressor.compress();
+        stringstream deltaBinary;
+        deltag->writeBinary(deltaBinary);
+        CfGrammar* loaded = CfGrammar::readBinary(deltaBinary);
+        // another version of the reference must be rejected
+        string otherRef = rotated;
+        otherRef[0] ^= 1;
+        if (deltag->expand() != str || loaded == 0 || loaded->setReferenceText(otherRef) || 
+            !loaded->setReferenceText(rotated) || loaded->expand() != str) cout << " !delta mismatch";
+        else cout << " delta match";
+        delete deltag; delete loaded;
+        // train dictionary on shifted copies of the string and compress with it
+        vector<string> samples;
+        samples.push_back(str.substr(1)); samples.push_back(str.substr(0, str.size() - 1));
+        CfGrammar* dict = DictionaryCompressor::train(samples, 1000, 2);
+        DictionaryCompressor dictCompressor(dict, 2);
+        CfGrammar* dictg = dictCompressor.compress(str);
+        // loading with another version of the dictionary must fail
+        stringstream dictBinary;
+        dictg->writeBinary(dictBinary);
+        CfGrammar* dictLoaded = CfGrammar::readBinary(dictBinary);
+        if (dictg->expand() != str || dictLoaded == 0 || 
+            dictLoaded->setReferenceText(dictCompressor.getText() + "x") || 
+            !dictLoaded->setReferenceText(dictCompressor.getText()) || 
+            dictLoaded->expand() != str) cout << " !dict mismatch";
+        else cout << " dict match";
+        delete dictg; delete dictLoaded; delete dict;
+        // serve compress request over a socket pair, client end is shut down 
+        // for writing so the connection is served in this thread
+        int fds[2];
+        bool svmiss = socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0;
+        if (!svmiss) {
+            CompressionServer server("", 1);
+            char status; string response;
+            CompressionServer::sendFrame(fds[0], CompressionServer::COMPRESS, str);
+            shutdown(fds[0], SHUT_WR);
+            server.serve(fds[1], workspace);
+            close(fds[1]);
+            svmiss = !CompressionServer::receiveFrame(fds[0], status, response) || 
+                     status != CompressionServer::OK;
+            close(fds[0]);
+            istringstream in(response);
+            CfGrammar* sg = svmiss ? 0 : CfGrammar::readBinary(in);
+            svmiss = sg == 0 || sg->expand() != str;
+            delete sg;
+        }
+        if (svmiss) cout << " !server mismatch";
+        else cout << " server match";
+        // compress and decompress through the C interface
+        cfg_esa_options options; cfg_esa_default_options(&options);
+        options.renumber = 1;
+        cfg_esa_context* context = cfg_esa_context_create();
+        char *binary = 0, *expanded = 0; size_t binarySize, expandedSize;
+        cfg_esa_metrics metrics;
+        bool apimiss = cfg_esa_compress(context, s, str.size(), &options, &binary, &binarySize, &metrics) != CFG_ESA_OK ||
+                       cfg_esa_decompress(binary, binarySize, &expanded, &expandedSize) != CFG_ESA_OK ||
+                       string(expanded, expandedSize) != str || metrics.grammar_size != g->getSize();
+        if (apimiss) cout << " !api mismatch";
+        else cout << " api match";
+        cfg_esa_free(binary); cfg_esa_free(expanded);
+        cfg_esa_context_destroy(context);
+        // compress records, the string and its halves, in batches of about two records
+        string records = str + "\n" + str.substr(0, half) + "\n\n" + str.substr(half);
+        RecordPipeline pipeline(RecordPipeline::LINES, str.size() + 1, 2);
+        istringstream recordsIn(records);
+        stringstream recordsCompressed;
+        ostringstream recordsOut;
+        bool rmiss = !pipeline.compress(recordsIn, recordsCompressed) || 
+                     !RecordPipeline::decompress(recordsCompressed, recordsOut, RecordPipeline::LINES) ||
+                     recordsOut.str() != records;
+        if (rmiss) cout << " !records mismatch";
+        else cout << " records match";
+        // estimate with the whole string as the sample predicts the exact grammar size
+        LongestFirstSaCompressor estimator(s, str.size());
+        if (estimator.estimate(str.size()).grammarSize != g->getSize()) cout << " !estimate mismatch";
+        else cout << " estimate match";
+        // verify against the string and the string with the last char changed
+        GrammarVerifier verifier(g);
+        string changed = str; changed[str.size()-1]++;
+        bool vmiss = !verifier.verify(s, str.size()) || verifier.spotCheck(s, str.size(), 8, 5) > 0 ||
+                     verifier.verify(changed.c_str(), changed.size());
+        if (vmiss) cout << " !verify mismatch";
+        else cout << " verify match";
+        // stop rule forming after the first interval, partial grammar must encode the string
+        LongestFirstSaCompressor budgeted(s, str.size());
+        budgeted.setWorkBudget(1);
+        CfGrammar* bg = budgeted.compress();
+        if (bg->expand() != str || bg->getSize() < g->getSize()) cout << " !budget mismatch";
+        else cout << " budget match";
+        delete bg;
+        // checkpoint at each level of a run stopped after the level of maximal lcp, 
+        // so that a checkpoint is written before the next level, resume must 
+        // start from it and give the same grammar as the uninterrupted compression
+        const string checkpoint = "test_checkpoint.tmp";
+        LongestFirstSaCompressor interrupted(s, str.size());
+        interrupted.setCheckpoint(checkpoint, 0, false);
+        interrupted.setWorkBudget(maxLcpPositions(str));
+        delete interrupted.compress();
+        LongestFirstSaCompressor resumed(s, str.size());
+        resumed.setCheckpoint(checkpoint, 0, true);
+        CfGrammar* rg = resumed.compress();
+        if (resumed.getResumedLcp() <= 0 || rg->toString() != result) cout << " !resume mismatch";
+        else cout << " resume match";
+        delete rg;
+        unlink(checkpoint.c_str());
         cout << endl;                
         
         if (gmiss) {
@@ -67,6 +253,62 @@ void Tests::runTests() {
     }
 }
 
+// compare all substrings extracted from the grammar with substrings of str
+bool Tests::checkAccess(CfGrammar* g, const string& str) {
+    GrammarAccess access(g);
+    if (access.length() != str.size()) return false;
+    for (int i = 0; i < str.size(); ++i) {
+        for (int l = 0; i + l <= str.size(); ++l) {
+            if (access.extract(i, l) != str.substr(i, l)) return false;
+        }
+    }
+    return true;
+}
+
+// search for all substrings of str of length up to 4 and a missing
+// pattern, compare occurrences with those found by scanning str
+bool Tests::checkSearch(CfGrammar* g, const string& str) {
+    GrammarSearch search(g);
+    vector<string> patterns;
+    for (int i = 0; i < str.size(); ++i) {
+        for (int l = 1; l <= 4 && i + l <= str.size(); ++l) {
+            patterns.push_back(str.substr(i, l));
+        }
+    }
+    patterns.push_back(str + "#");
+    for (int i = 0; i < patterns.size(); ++i) search.addPattern(patterns[i]);
+    for (int i = 0; i < patterns.size(); ++i) {
+        vector<int> pos;
+        for (size_t p = str.find(patterns[i]); p != string::npos; p = str.find(patterns[i], p+1)) {
+            pos.push_back(p);
+        }
+        if (search.count(i) != pos.size() || search.positions(i) != pos) return false;
+    }
+    return true;
+}
+
+// number of suffix positions in the lcp intervals of maximal lcp, 
+// calculated from the naively sorted suffixes
+long Tests::maxLcpPositions(const string& str) {
+    vector<string> suffixes;
+    for (int i = 0; i < str.size(); ++i) suffixes.push_back(str.substr(i));
+    sort(suffixes.begin(), suffixes.end());
+    vector<int> lcp(suffixes.size(), 0); // lcp of the suffix and the previous one
+    int maxLcp = 0;
+    for (int i = 1; i < suffixes.size(); ++i) {
+        const string& a = suffixes[i-1]; const string& b = suffixes[i];
+        while (lcp[i] < a.size() && lcp[i] < b.size() && a[lcp[i]] == b[lcp[i]]) lcp[i]++;
+        maxLcp = max(maxLcp, lcp[i]);
+    }
+    // each run of suffixes with lcp equal to maximal one is an interval
+    long positions = 0;
+    for (int i = 1; i < suffixes.size(); ++i) {
+        if (lcp[i] != maxLcp) continue;
+        positions += (i == 1 || lcp[i-1] != maxLcp) ? 2 : 1;
+    }
+    return positions;
+}
+
 int Tests::strToInt(string str) {
     return atoi(str.c_str());
 }
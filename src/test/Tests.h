@@ -14,15 +14,34 @@
 #ifndef TESTS_H
 #define	TESTS_H
 
+#include <algorithm>
 #include <string>
+#include <vector>
 #include <fstream>
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
 #include <cstring>
+#include <cmath>
+#include <sys/socket.h>
+#include <unistd.h>
 
 #include "compress/CfGrammar.h"
 #include "compress/LongestFirstSaCompressor.h"
+#include "compress/GrammarAccess.h"
+#include "compress/GrammarSearch.h"
+#include "compress/RuleInliner.h"
+#include "compress/GrammarBalancer.h"
+#include "compress/DocumentSetCompressor.h"
+#include "compress/StreamCompressor.h"
+#include "compress/GrammarAppender.h"
+#include "compress/DeltaCompressor.h"
+#include "compress/DictionaryCompressor.h"
+#include "compress/GrammarVerifier.h"
+#include "parallel/ChunkCompressor.h"
+#include "parallel/CompressionServer.h"
+#include "parallel/RecordPipeline.h"
+#include "api/cfg_esa.h"
 
 using namespace std;
 
@@ -36,11 +55,15 @@ private:
     static const string testFile;
     static const string commentPrefix;
     ifstream file;
+    CompressorWorkspace workspace;
 
     string readLine();    
     string trim(string);
     bool isComment(string str);
     int strToInt(string str);
+    bool checkAccess(CfGrammar* g, const string& str);
+    bool checkSearch(CfGrammar* g, const string& str);
+    long maxLcpPositions(const string& str);
     
 };
 
@@ -0,0 +1,73 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "HardwareCounters.h"
+
+const char* const HardwareCounters::NAMES[] = { 
+    "cycles", "instructions", "llc_misses", "dtlb_misses", "branch_misses" 
+};
+
+// perf event type and config of the counters
+static void eventOf(int c, __u32& type, __u64& config) {
+    const __u64 readMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    switch (c) {
+        case HW_CYCLES: type = PERF_TYPE_HARDWARE; config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case HW_INSTRUCTIONS: type = PERF_TYPE_HARDWARE; config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case HW_LLC_MISSES: type = PERF_TYPE_HW_CACHE; config = PERF_COUNT_HW_CACHE_LL | readMiss; break;
+        case HW_DTLB_MISSES: type = PERF_TYPE_HW_CACHE; config = PERF_COUNT_HW_CACHE_DTLB | readMiss; break;
+        default: type = PERF_TYPE_HARDWARE; config = PERF_COUNT_HW_BRANCH_MISSES; break;
+    }
+}
+
+HardwareCounters::HardwareCounters() {
+    for (int c = 0; c < NUM_HW_COUNTERS; ++c) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        eventOf(c, attr.type, attr.config);
+        attr.exclude_kernel = 1; // allowed with perf_event_paranoid 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // calling thread on any cpu
+        fds[c] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fds[c] < 0 && error.empty()) error = string(NAMES[c]) + ": " + strerror(errno);
+    }
+}
+
+HardwareCounters::~HardwareCounters() {
+    for (int c = 0; c < NUM_HW_COUNTERS; ++c) if (fds[c] >= 0) close(fds[c]);
+}
+
+// current counter values, 0 for unavailable counters
+void HardwareCounters::read(long long values[NUM_HW_COUNTERS]) {
+    for (int c = 0; c < NUM_HW_COUNTERS; ++c) {
+        values[c] = 0;
+        if (fds[c] < 0) continue;
+        unsigned long long buf[3]; // value, time enabled, time running
+        if (::read(fds[c], buf, sizeof(buf)) != sizeof(buf)) continue;
+        if (buf[2] > 0 && buf[2] < buf[1]) values[c] = (long long)((double)buf[0] * buf[1] / buf[2]);
+        else values[c] = buf[0];
+    }
+}
+
+bool HardwareCounters::isAvailable(HardwareCounter c) const { return fds[c] >= 0; }
+
+// reason why the first unavailable counter could not be opened, empty if all are available
+const string& HardwareCounters::getError() const { return error; }
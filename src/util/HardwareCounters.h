@@ -0,0 +1,49 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef HARDWARECOUNTERS_H
+#define	HARDWARECOUNTERS_H
+
+#include <string>
+
+using namespace std;
+
+enum HardwareCounter { 
+    HW_CYCLES, HW_INSTRUCTIONS, HW_LLC_MISSES, HW_DTLB_MISSES, HW_BRANCH_MISSES, 
+    NUM_HW_COUNTERS 
+};
+
+/* Hardware performance counters of the calling thread, user space only, 
+ * opened with perf_event_open. Counters that can not be opened (no PMU, 
+ * perf_event_paranoid, seccomp in a container) are marked unavailable and 
+ * read as 0, the reason of the first failure is kept. Values are scaled 
+ * when the kernel multiplexes the counters. A set of counters must be read 
+ * only by the thread that created it. */
+class HardwareCounters {
+public:
+    HardwareCounters();
+    virtual ~HardwareCounters();
+    
+    void read(long long values[NUM_HW_COUNTERS]);
+    bool isAvailable(HardwareCounter c) const;
+    const string& getError() const;
+    
+    static const char* const NAMES[];
+    
+private:
+    int fds[NUM_HW_COUNTERS];
+    string error;
+    
+};
+
+#endif	/* HARDWARECOUNTERS_H */
@@ -0,0 +1,197 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#include <ctime>
+
+#include "Profiler.h"
+
+double getWallTime() { return getWallNanos() / 1e9; }
+
+double getThreadTime() { return getThreadNanos() / 1e9; }
+
+long long getWallNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+long long getThreadNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+const char* const Profiler::COUNTER_NAMES[] = { 
+    "intervals_visited", "positions_classified", "rule_position_steps", "rules_created", 
+    "shortened_requeued" 
+};
+
+bool Profiler::enabled = false;
+bool Profiler::hardwareEnabled = false;
+__thread Profiler::ThreadProfile* Profiler::current = 0;
+vector<Profiler::ThreadProfile*> Profiler::threads;
+pthread_mutex_t Profiler::threadsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+void Profiler::enable(bool on) { enabled = on; }
+
+// hardware counters are opened by threads that record after this call
+void Profiler::enableHardwareCounters(bool on) { hardwareEnabled = on; }
+
+Profiler::Scope::Scope(): calls(0), wallNs(0), cpuNs(0) {
+    for (int c = 0; c < NUM_HW_COUNTERS; ++c) hw[c] = 0;
+}
+
+void Profiler::ThreadProfile::reset() {
+    scopes.assign(1, Scope());
+    open.assign(1, 0);
+    wallStart.assign(1, 0); cpuStart.assign(1, 0);
+    hwStart.assign(NUM_HW_COUNTERS, 0);
+    for (int c = 0; c < NUM_PROFILE_COUNTERS; ++c) counters[c] = 0;
+}
+
+// profile of the calling thread, created on first use
+Profiler::ThreadProfile* Profiler::threadProfile() {
+    if (current == 0) {
+        current = new ThreadProfile();
+        current->reset();
+        current->hw = hardwareEnabled ? new HardwareCounters() : 0;
+        pthread_mutex_lock(&threadsMutex);
+        threads.push_back(current);
+        pthread_mutex_unlock(&threadsMutex);
+    }
+    return current;
+}
+
+// index of the child scope with given name, created if it does not exist
+int Profiler::child(vector<Scope>& scopes, int parent, const string& name) {
+    map<string, int>::iterator it = scopes[parent].children.find(name);
+    if (it != scopes[parent].children.end()) return it->second;
+    Scope s; s.name = name;
+    scopes.push_back(s);
+    const int index = scopes.size() - 1;
+    scopes[parent].children[name] = index;
+    scopes[parent].order.push_back(index);
+    return index;
+}
+
+void Profiler::beginScope(const char* name) {
+    ThreadProfile* p = threadProfile();
+    p->open.push_back(child(p->scopes, p->open.back(), name));
+    if (p->hw != 0) {
+        long long values[NUM_HW_COUNTERS];
+        p->hw->read(values);
+        p->hwStart.insert(p->hwStart.end(), values, values + NUM_HW_COUNTERS);
+    }
+    p->wallStart.push_back(getWallNanos());
+    p->cpuStart.push_back(getThreadNanos());
+}
+
+void Profiler::endScope() {
+    const long long wall = getWallNanos(), cpu = getThreadNanos();
+    ThreadProfile* p = threadProfile();
+    if (p->open.size() < 2) return; // scope began before clear()
+    Scope& s = p->scopes[p->open.back()];
+    s.calls++;
+    s.wallNs += wall - p->wallStart.back();
+    s.cpuNs += cpu - p->cpuStart.back();
+    if (p->hw != 0) {
+        long long values[NUM_HW_COUNTERS];
+        p->hw->read(values);
+        const int start = p->hwStart.size() - NUM_HW_COUNTERS;
+        for (int c = 0; c < NUM_HW_COUNTERS; ++c) s.hw[c] += values[c] - p->hwStart[start + c];
+        p->hwStart.resize(start);
+    }
+    p->open.pop_back(); p->wallStart.pop_back(); p->cpuStart.pop_back();
+}
+
+// add the scope of a thread and its descendants to the merged scope
+void Profiler::merge(const ThreadProfile& from, int fromScope, vector<Scope>& to, int toScope) {
+    const Scope& s = from.scopes[fromScope];
+    for (int i = 0; i < s.order.size(); ++i) {
+        const Scope& c = from.scopes[s.order[i]];
+        int merged = child(to, toScope, c.name);
+        to[merged].calls += c.calls; 
+        to[merged].wallNs += c.wallNs; 
+        to[merged].cpuNs += c.cpuNs;
+        for (int h = 0; h < NUM_HW_COUNTERS; ++h) to[merged].hw[h] += c.hw[h];
+        merge(from, s.order[i], to, merged);
+    }
+}
+
+// write a scope with the available hardware counters (mask) and its children
+void Profiler::writeScope(ostream& out, const vector<Scope>& scopes, int scope, int hwMask) {
+    const Scope& s = scopes[scope];
+    out << "{\"name\": \"" << s.name << "\", \"calls\": " << s.calls << ", \"wall_ns\": " << s.wallNs
+        << ", \"cpu_ns\": " << s.cpuNs;
+    for (int c = 0; c < NUM_HW_COUNTERS; ++c) {
+        if (hwMask & (1 << c)) out << ", \"" << HardwareCounters::NAMES[c] << "\": " << s.hw[c];
+    }
+    out << ", \"children\": [";
+    for (int i = 0; i < s.order.size(); ++i) {
+        if (i > 0) out << ", ";
+        writeScope(out, scopes, s.order[i], hwMask);
+    }
+    out << "]}";
+}
+
+// write scopes and counters of all threads merged
+void Profiler::writeJson(ostream& out) {
+    vector<Scope> merged(1);
+    long counters[NUM_PROFILE_COUNTERS] = { 0 };
+    // hardware counters available in all threads that opened them
+    int hwMask = 0; bool hwOpened = false;
+    string hwError;
+    pthread_mutex_lock(&threadsMutex);
+    for (int t = 0; t < threads.size(); ++t) {
+        merge(*threads[t], 0, merged, 0);
+        for (int c = 0; c < NUM_PROFILE_COUNTERS; ++c) counters[c] += threads[t]->counters[c];
+        const HardwareCounters* hw = threads[t]->hw;
+        if (hw == 0) continue;
+        if (!hwOpened) hwMask = (1 << NUM_HW_COUNTERS) - 1;
+        hwOpened = true;
+        for (int c = 0; c < NUM_HW_COUNTERS; ++c) {
+            if (!hw->isAvailable((HardwareCounter)c)) hwMask &= ~(1 << c);
+        }
+        if (hwError.empty()) hwError = hw->getError();
+    }
+    const int numThreads = threads.size();
+    pthread_mutex_unlock(&threadsMutex);
+    out << "{\"threads\": " << numThreads;
+    if (hwOpened) {
+        out << ", \"hardware_counters\": [";
+        bool first = true;
+        for (int c = 0; c < NUM_HW_COUNTERS; ++c) {
+            if ((hwMask & (1 << c)) == 0) continue;
+            out << (first ? "" : ", ") << "\"" << HardwareCounters::NAMES[c] << "\"";
+            first = false;
+        }
+        out << "]";
+        if (!hwError.empty()) out << ", \"hardware_error\": \"" << hwError << "\"";
+    }
+    out << ", \"scopes\": [";
+    for (int i = 0; i < merged[0].order.size(); ++i) {
+        if (i > 0) out << ", ";
+        writeScope(out, merged, merged[0].order[i], hwMask);
+    }
+    out << "], \"counters\": {";
+    for (int c = 0; c < NUM_PROFILE_COUNTERS; ++c) {
+        out << (c > 0 ? ", " : "") << "\"" << COUNTER_NAMES[c] << "\": " << counters[c];
+    }
+    out << "}}" << endl;
+}
+
+void Profiler::clear() {
+    pthread_mutex_lock(&threadsMutex);
+    for (int t = 0; t < threads.size(); ++t) threads[t]->reset();
+    pthread_mutex_unlock(&threadsMutex);
+}
@@ -0,0 +1,117 @@
+// Copyright 2014 Damir Korencic
+//
+// This file is part of cfg_esa - program 
+// for longest first context free grammar compression using enhanced suffix array 
+//
+// The code can be used only for the purpose of reviewing the article 
+// "Using Static Suffix Array in Dynamic Application: Case
+//  of Text Compression by Longest First Substitution "
+// authored by Strahil Ristov and Damir Korencic
+// 
+// The redistribution of the code is not allowed.
+// After the article is published the code will be published
+// under an open source licence. 
+#ifndef PROFILER_H
+#define	PROFILER_H
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include "HardwareCounters.h"
+
+using namespace std;
+
+// monotonic wall clock and cpu time of the calling thread, in seconds
+double getWallTime();
+double getThreadTime();
+// the same clocks in nanoseconds
+long long getWallNanos();
+long long getThreadNanos();
+
+enum ProfileCounter { 
+    INTERVALS_VISITED, POSITIONS_CLASSIFIED, RULE_POSITION_STEPS, RULES_CREATED, 
+    SHORTENED_REQUEUED, NUM_PROFILE_COUNTERS 
+};
+
+/* Instrumentation with nested timed scopes and event counters. Each thread 
+ * records wall and cpu time of its scopes into its own table, without 
+ * locking, and the tables of all threads are merged by scope path when 
+ * written as JSON. Profiling is disabled by default, then scopes and 
+ * counters cost only a test of a flag. If hardware counters are enabled, 
+ * each thread opens its own set and scopes also accumulate the counters 
+ * that are available. Clear and write only when no thread is recording. */
+class Profiler {
+public:
+    static void enable(bool on);
+    static void enableHardwareCounters(bool on);
+    static inline bool isEnabled() { return enabled; }
+    
+    static void beginScope(const char* name);
+    static void endScope();
+    static inline void count(ProfileCounter c, long n = 1) { 
+        if (enabled) threadProfile()->counters[c] += n; 
+    }
+    
+    static void writeJson(ostream& out);
+    static void clear();
+    
+    static const char* const COUNTER_NAMES[];
+    
+private:
+    
+    struct Scope {
+        Scope();
+        string name;
+        long calls;
+        long long wallNs, cpuNs;
+        long long hw[NUM_HW_COUNTERS];
+        map<string, int> children; // name -> index of the child scope
+        vector<int> order; // children in order of first entry
+    };
+    
+    // scope tree of a thread, scope 0 is the root
+    struct ThreadProfile {
+        vector<Scope> scopes;
+        vector<int> open; // path of open scopes
+        vector<long long> wallStart, cpuStart;
+        long counters[NUM_PROFILE_COUNTERS];
+        HardwareCounters* hw; // 0 if hardware counters are disabled
+        vector<long long> hwStart; // NUM_HW_COUNTERS values per open scope
+        void reset();
+    };
+    
+    static bool enabled, hardwareEnabled;
+    static __thread ThreadProfile* current;
+    static vector<ThreadProfile*> threads;
+    static pthread_mutex_t threadsMutex;
+    
+    static ThreadProfile* threadProfile();
+    static int child(vector<Scope>& scopes, int parent, const string& name);
+    static void merge(const ThreadProfile& from, int fromScope, vector<Scope>& to, int toScope);
+    static void writeScope(ostream& out, const vector<Scope>& scopes, int scope, int hwMask);
+    
+};
+
+/* Times the enclosing block as a scope if profiling is enabled. If time 
+ * is given, wall time of the block in seconds is stored there also when 
+ * profiling is disabled. */
+class ProfileScope {
+public:
+    ProfileScope(const char* name, double* time = 0): active(Profiler::isEnabled()), wallTime(time) { 
+        if (active) Profiler::beginScope(name); 
+        if (wallTime != 0) start = getWallNanos();
+    }
+    ~ProfileScope() { 
+        if (wallTime != 0) *wallTime = (getWallNanos() - start) / 1e9;
+        if (active) Profiler::endScope(); 
+    }
+private:
+    bool active;
+    double* wallTime;
+    long long start;
+};
+
+#endif	/* PROFILER_H */